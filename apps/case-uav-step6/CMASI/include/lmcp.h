@@ -18,6 +18,8 @@ uint32_t lmcp_packsize(lmcp_object* o);
 void lmcp_free(lmcp_object* o);
 int lmcp_make_msg(uint8_t* buf, lmcp_object *o);
 //int lmcp_process_addr_attrib_msg(uint8_t** inb, size_t size, AddressAttributedMessage **o);
+// Find the LMCP object of the address attributed message of size octets at *inb
+int lmcp_find_msg(uint8_t** inb, size_t size, uint8_t** object, size_t* object_size);
 int lmcp_process_msg(uint8_t** inb, size_t size, lmcp_object **o);
 int lmcp_unpack(uint8_t** inb, size_t size, lmcp_object **o);
 //int lmcp_unpack(uint8_t** inb, size_t size, uint32_t objtype, lmcp_object **o);
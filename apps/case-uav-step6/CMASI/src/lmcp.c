@@ -43,23 +43,29 @@ size_t compute_addr_attr_lmcp_message_size(void *buffer, size_t buffer_length)
   ssize_t end_of_attr_delim_offset = end_of_attr_delim - buffer;
   
   const size_t lmcp_control_string_size = 4;
+  const size_t lmcp_message_size_size = 4;
   const size_t checksum_size = 4;
 
-  uint8_t *lmcp_message_size_pos = end_of_attr_delim + sizeof(addr_attr_delim) + lmcp_control_string_size;
+  // Offsets rather than pointers, so that a size near SIZE_MAX cannot wrap
+  size_t lmcp_message_size_offset = end_of_attr_delim_offset + sizeof(addr_attr_delim) + lmcp_control_string_size;
+  if (buffer_length < lmcp_message_size_offset + lmcp_message_size_size + checksum_size) {
+    errno = -3;
+    return 0;
+  }
+
+  uint8_t *lmcp_message_size_pos = (uint8_t *) buffer + lmcp_message_size_offset;
   size_t lmcp_message_size = ((size_t) lmcp_message_size_pos[0] << 24)
     + ((size_t) lmcp_message_size_pos[1] << 16)
     + ((size_t) lmcp_message_size_pos[2] <<  8)
     + ((size_t) lmcp_message_size_pos[3] <<  0);
     
-  if (buffer + buffer_length < ((void *) lmcp_message_size_pos) + lmcp_message_size + checksum_size) {
-    fprintf(stdout, "apss: compute_addr_attr_lmcp_message_size: EoAddr %zu, EoAttr %zu, LMCP sz %zu\n",
-	    end_of_address_delim_offset, end_of_attr_delim_offset, lmcp_message_size); fflush(stdout);
+  if (buffer_length - lmcp_message_size_offset - lmcp_message_size_size - checksum_size < lmcp_message_size) {
     errno = -4;
     return 0;
   }
 
   errno = 0;
-  return ((size_t) ((void *) lmcp_message_size_pos - buffer)) + lmcp_control_string_size + lmcp_message_size + checksum_size;
+  return lmcp_message_size_offset + lmcp_message_size_size + lmcp_message_size + checksum_size;
 }
 
 void lmcp_pp(lmcp_object *o) {
@@ -341,7 +347,7 @@ int lmcp_make_msg(uint8_t* buf, lmcp_object* o) {
 // }
 
 
-int lmcp_process_msg(uint8_t** inb, size_t size, lmcp_object **o) {
+int lmcp_find_msg(uint8_t** inb, size_t size, uint8_t** object, size_t* object_size) {
 
     // if (size < 8) {
     //     return -1;
@@ -381,6 +387,16 @@ int lmcp_process_msg(uint8_t** inb, size_t size, lmcp_object **o) {
         return -1;
     }
 
+    *object = startPtr;
+    *object_size = msglen;
+    return 0;
+}
+
+int lmcp_process_msg(uint8_t** inb, size_t size, lmcp_object **o) {
+    uint8_t * startPtr;
+    size_t msglen;
+    CHECK(lmcp_find_msg(inb, size, &startPtr, &msglen))
+
 //    uint32_t objtype;
 //    uint16_t objseries;
 //    char seriesname[8];
@@ -17,6 +17,7 @@
 #include <sys/types.h>
 
 #include "hexdump.h"
+#include "lmcp.h"
 
 // Forward declarations
 void operating_region_out_event_data_send(data_t *data);
@@ -41,6 +42,17 @@ bool operating_region_in_event_data_poll(counter_t *numDropped, data_t *data) {
     return queue_dequeue(&operatingRegionInRecvQueue, numDropped, data);
 }
 
+// As operating_region_in_event_data_poll, into the size octets at buffer
+bool operating_region_in_event_bytes_poll(counter_t *numDropped, uint8_t *buffer, size_t size) {
+    return queue_dequeue_bytes(&operatingRegionInRecvQueue, numDropped, buffer, size);
+}
+
+// As operating_region_in_event_bytes_poll, copying only the message, whose size is
+// returned in length
+bool operating_region_in_event_message_poll(counter_t *numDropped, uint8_t *buffer, size_t size, size_t *length) {
+    return queue_dequeue_measured(&operatingRegionInRecvQueue, numDropped, buffer, size, compute_addr_attr_lmcp_message_size, length);
+}
+
 
 //------------------------------------------------------------------------------
 // User specified input data receive handler for AADL Input Event Data Port (in) named
@@ -59,6 +71,17 @@ bool line_search_task_in_event_data_poll(counter_t *numDropped, data_t *data) {
     return queue_dequeue(&lineSearchTaskInRecvQueue, numDropped, data);
 }
 
+// As line_search_task_in_event_data_poll, into the size octets at buffer
+bool line_search_task_in_event_bytes_poll(counter_t *numDropped, uint8_t *buffer, size_t size) {
+    return queue_dequeue_bytes(&lineSearchTaskInRecvQueue, numDropped, buffer, size);
+}
+
+// As line_search_task_in_event_bytes_poll, copying only the message, whose size is
+// returned in length
+bool line_search_task_in_event_message_poll(counter_t *numDropped, uint8_t *buffer, size_t size, size_t *length) {
+    return queue_dequeue_measured(&lineSearchTaskInRecvQueue, numDropped, buffer, size, compute_addr_attr_lmcp_message_size, length);
+}
+
 
 //------------------------------------------------------------------------------
 // User specified input data receive handler for AADL Input Event Data Port (in) named
@@ -77,6 +100,17 @@ bool automation_request_in_event_data_poll(counter_t *numDropped, data_t *data)
     return queue_dequeue(&automationRequestInRecvQueue, numDropped, data);
 }
 
+// As automation_request_in_event_data_poll, into the size octets at buffer
+bool automation_request_in_event_bytes_poll(counter_t *numDropped, uint8_t *buffer, size_t size) {
+    return queue_dequeue_bytes(&automationRequestInRecvQueue, numDropped, buffer, size);
+}
+
+// As automation_request_in_event_bytes_poll, copying only the message, whose size is
+// returned in length
+bool automation_request_in_event_message_poll(counter_t *numDropped, uint8_t *buffer, size_t size, size_t *length) {
+    return queue_dequeue_measured(&automationRequestInRecvQueue, numDropped, buffer, size, compute_addr_attr_lmcp_message_size, length);
+}
+
 
 //------------------------------------------------------------------------------
 // User specified input data receive handler for AADL Input Event Data Port (in) named
@@ -120,9 +154,27 @@ void line_search_task_out_event_data_send(data_t *data) {
 
 void automation_request_out_event_data_send(data_t *data) {
     queue_enqueue(automation_request_out_1_queue, data);
-    queue_enqueue(automation_request_out_2_queue, data);
     automation_request_out_1_SendEvent_emit();
-    automation_request_out_2_SendEvent_emit();
+    done_emit();
+}
+
+// As the event data sends, the payload being the size octets at bytes
+
+void operating_region_out_event_bytes_send(const uint8_t *bytes, size_t size) {
+    queue_enqueue_bytes(operating_region_out_queue, bytes, size);
+    operating_region_out_SendEvent_emit();
+    done_emit();
+}
+
+void line_search_task_out_event_bytes_send(const uint8_t *bytes, size_t size) {
+    queue_enqueue_bytes(line_search_task_out_queue, bytes, size);
+    line_search_task_out_SendEvent_emit();
+    done_emit();
+}
+
+void automation_request_out_event_bytes_send(const uint8_t *bytes, size_t size) {
+    queue_enqueue_bytes(automation_request_out_1_queue, bytes, size);
+    automation_request_out_1_SendEvent_emit();
     done_emit();
 }
 
@@ -169,7 +221,6 @@ void post_init(void) {
     queue_init(operating_region_out_queue);
     queue_init(line_search_task_out_queue);
     queue_init(automation_request_out_1_queue);
-    queue_init(automation_request_out_2_queue);
 }
 
 /* Implemented by CakeML */
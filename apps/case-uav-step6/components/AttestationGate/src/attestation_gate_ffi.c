@@ -13,6 +13,7 @@
 #include <sys/types.h>
 
 #include "hexdump.h"
+#include "lmcp.h"
 
 
 char attestationMsgBuffer[256];
@@ -53,10 +54,42 @@ void dumpBuffer(size_t numBytes, uint8_t* buffer) {
   fflush(stdout);
 } 
 
-void clearattestationData() {
-  for (int i = 0 ; i < sizeof(attestationIds->payload) ; ++i) {
-    attestationData->payload[i] = 0;
+// The message got on a port is dequeued straight to output after its event
+// flag, and what earlier gets left after it is zeroed, so CakeML sees what it
+// did when the whole payload was cleared and copied
+size_t payloadSizeBytes(long outputSizeBytes) {
+  if (outputSizeBytes < 1) {
+    return 0;
   }
+  return ((size_t) outputSizeBytes - 1 < attestationDataSizeBytes) ? (size_t) outputSizeBytes - 1 : attestationDataSizeBytes;
+}
+
+// Zero the octets of the payload after the message got into it that earlier
+// gets left there; *written is how far into the payload they wrote, SIZE_MAX
+// before the first. CakeML reuses the buffer it gets into, so the octets past
+// *written are still zero, and only the tail a longer message left is cleared
+void clearPayloadTail(uint8_t *payload, size_t payloadSize, size_t messageSize, size_t *written) {
+  size_t end = (*written < payloadSize) ? *written : payloadSize;
+  if (messageSize < end) {
+    memset(payload + messageSize, 0, end - messageSize);
+  }
+  *written = messageSize;
+}
+
+// Note a get that failed after writing messageSize octets of the payload
+void notePayloadWritten(size_t messageSize, size_t *written) {
+  if (messageSize > *written) {
+    *written = messageSize;
+  }
+}
+
+// CakeML sends its whole buffer; only the message at the front of it, as
+// measured by compute_addr_attr_lmcp_message_size, is enqueued, the queue
+// zeroing the rest of the payload. If it cannot be measured all size octets
+// are sent, as before
+size_t sentSizeBytes(unsigned char *parameter, size_t size) {
+  size_t messageSize = compute_addr_attr_lmcp_message_size(parameter, size);
+  return (0 < messageSize && messageSize < size) ? messageSize : size;
 }
 
 void clearattestationIds() {
@@ -108,17 +141,21 @@ void ffiapi_get_trusted_ids(unsigned char *parameter, long parameterSizeBytes, u
   
 }
 
-extern bool automation_request_in_event_data_poll(counter_t *, data_t *);
+extern bool automation_request_in_event_message_poll(counter_t *, uint8_t *, size_t, size_t *);
 
 void ffiapi_get_AutomationRequest_in(unsigned char *parameter, long parameterSizeBytes, unsigned char *output, long outputSizeBytes) {
+  static size_t written = SIZE_MAX;
   counter_t numRcvd = 0;
+  size_t payloadSize = payloadSizeBytes(outputSizeBytes);
+  size_t messageSize = 0;
 
   checkBufferOverrun(outputSizeBytes, attestationDataSizeBytes);
-  clearattestationData();
 
-  output[0] = automation_request_in_event_data_poll(&numRcvd, attestationData);
+  output[0] = automation_request_in_event_message_poll(&numRcvd, output+1, payloadSize, &messageSize);
   if (output[0]) {
-    memcpy(output+1, attestationData->payload, attestationDataSizeBytes);
+    clearPayloadTail(output+1, payloadSize, messageSize, &written);
+  } else {
+    notePayloadWritten(messageSize, &written);
   }
   if (numRcvd > 0) {
     sprintf(attestationMsgBuffer, "\n\treceived AutomationRequest (%ld)", numRcvd);
@@ -127,26 +164,34 @@ void ffiapi_get_AutomationRequest_in(unsigned char *parameter, long parameterSiz
   
 }
 
-extern void automation_request_out_event_data_send(data_t*);
+extern void automation_request_out_event_bytes_send(const uint8_t *, size_t);
 
 void ffiapi_send_AutomationRequest_out(unsigned char *parameter, long parameterSizeBytes, unsigned char *output, long outputSizeBytes) {
-  checkBufferOverrun(attestationDataSizeBytes, parameterSizeBytes);
-  clearattestationData();
-  memcpy(attestationData->payload, parameter, parameterSizeBytes);
-  automation_request_out_event_data_send(attestationData);
+  size_t size = parameterSizeBytes;
+
+  checkBufferOverrun(attestationDataSizeBytes, size);
+  if (size > attestationDataSizeBytes) {
+    size = attestationDataSizeBytes;
+  }
+  size = sentSizeBytes(parameter, size);
+  automation_request_out_event_bytes_send(parameter, size);
 }
 
-extern bool operating_region_in_event_data_poll(counter_t *, data_t *);
+extern bool operating_region_in_event_message_poll(counter_t *, uint8_t *, size_t, size_t *);
 
 void ffiapi_get_OperatingRegion_in(unsigned char *parameter, long parameterSizeBytes, unsigned char *output, long outputSizeBytes) {
+  static size_t written = SIZE_MAX;
   counter_t numRcvd = 0;
+  size_t payloadSize = payloadSizeBytes(outputSizeBytes);
+  size_t messageSize = 0;
 
   checkBufferOverrun(outputSizeBytes, attestationDataSizeBytes);
-  clearattestationData();
 
-  output[0] = operating_region_in_event_data_poll(&numRcvd, attestationData);
+  output[0] = operating_region_in_event_message_poll(&numRcvd, output+1, payloadSize, &messageSize);
   if (output[0]) {
-    memcpy(output+1, attestationData->payload, attestationDataSizeBytes);
+    clearPayloadTail(output+1, payloadSize, messageSize, &written);
+  } else {
+    notePayloadWritten(messageSize, &written);
   }
   if (numRcvd > 0) {
     sprintf(attestationMsgBuffer, "\n\treceived OperatingRegion (%ld)", numRcvd);
@@ -155,26 +200,34 @@ void ffiapi_get_OperatingRegion_in(unsigned char *parameter, long parameterSizeB
   
 }
 
-extern void operating_region_out_event_data_send(data_t*);
+extern void operating_region_out_event_bytes_send(const uint8_t *, size_t);
 
 void ffiapi_send_OperatingRegion_out(unsigned char *parameter, long parameterSizeBytes, unsigned char *output, long outputSizeBytes) {
-  checkBufferOverrun(attestationDataSizeBytes, parameterSizeBytes);
-  clearattestationData();
-  memcpy(attestationData->payload, parameter, parameterSizeBytes);
-  operating_region_out_event_data_send(attestationData);
+  size_t size = parameterSizeBytes;
+
+  checkBufferOverrun(attestationDataSizeBytes, size);
+  if (size > attestationDataSizeBytes) {
+    size = attestationDataSizeBytes;
+  }
+  size = sentSizeBytes(parameter, size);
+  operating_region_out_event_bytes_send(parameter, size);
 }
 
-extern bool line_search_task_in_event_data_poll(counter_t *, data_t *);
+extern bool line_search_task_in_event_message_poll(counter_t *, uint8_t *, size_t, size_t *);
 
 void ffiapi_get_LineSearchTask_in(unsigned char *parameter, long parameterSizeBytes, unsigned char *output, long outputSizeBytes) {
+  static size_t written = SIZE_MAX;
   counter_t numRcvd = 0;
+  size_t payloadSize = payloadSizeBytes(outputSizeBytes);
+  size_t messageSize = 0;
 
   checkBufferOverrun(outputSizeBytes, attestationDataSizeBytes);
-  clearattestationData();
 
-  output[0] = line_search_task_in_event_data_poll(&numRcvd, attestationData);
+  output[0] = line_search_task_in_event_message_poll(&numRcvd, output+1, payloadSize, &messageSize);
   if (output[0]) {
-    memcpy(output+1, attestationData->payload, attestationDataSizeBytes);
+    clearPayloadTail(output+1, payloadSize, messageSize, &written);
+  } else {
+    notePayloadWritten(messageSize, &written);
   }
   if (numRcvd > 0) {
     sprintf(attestationMsgBuffer, "\n\treceived LineSearchTask (%ld)", numRcvd);
@@ -183,13 +236,17 @@ void ffiapi_get_LineSearchTask_in(unsigned char *parameter, long parameterSizeBy
   
 }
 
-extern void line_search_task_out_event_data_send(data_t*);
+extern void line_search_task_out_event_bytes_send(const uint8_t *, size_t);
 
 void ffiapi_send_LineSearchTask_out(unsigned char *parameter, long parameterSizeBytes, unsigned char *output, long outputSizeBytes) {
-  checkBufferOverrun(attestationDataSizeBytes, parameterSizeBytes);
-  clearattestationData();
-  memcpy(attestationData->payload, parameter, parameterSizeBytes);
-  line_search_task_out_event_data_send(attestationData);
+  size_t size = parameterSizeBytes;
+
+  checkBufferOverrun(attestationDataSizeBytes, size);
+  if (size > attestationDataSizeBytes) {
+    size = attestationDataSizeBytes;
+  }
+  size = sentSizeBytes(parameter, size);
+  line_search_task_out_event_bytes_send(parameter, size);
 }
 
 /**
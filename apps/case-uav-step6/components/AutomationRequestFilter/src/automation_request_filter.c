@@ -15,10 +15,16 @@
 #include <sys/types.h>
 
 #include "hexdump.h"
+#include "message_schemas.h"
+#include "message_validator.h"
+#include "port_executive.h"
 
 // Forward declarations
 void automation_request_out_event_data_send(data_t *data);
 
+// The automation request schema, compiled
+validator_t automationRequestValidator;
+
 
 //------------------------------------------------------------------------------
 // User specified input data receive handler for AADL Input Event Data Port (in) named
@@ -26,7 +32,14 @@ void automation_request_out_event_data_send(data_t *data);
 void automation_request_in_event_data_receive(counter_t numDropped, data_t *data) {
     printf("%s: received automation request: numDropped: %" PRIcounter "\n", get_instance_name(), numDropped); fflush(stdout);
     // hexdump("    ", 32, data->payload, sizeof(data->payload));
-    automation_request_out_event_data_send(data);
+
+    validator_result_t result;
+    if (validator_check_message(&automationRequestValidator, data->payload, sizeof(data->payload), &result)) {
+        automation_request_out_event_data_send(data);
+    } else {
+        printf("%s: automation request is not valid: %s at octet %zu\n", get_instance_name(),
+               (result.path != NULL) ? result.path : "LMCP header", result.offset); fflush(stdout);
+    }
 }
 
 
@@ -58,17 +71,28 @@ void automation_request_out_event_data_send(data_t *data) {
 }
 
 
-void run_poll(void) {
+static data_t portData;
+
+static bool service_automation_request_in(void *context) {
+    (void) context;
     counter_t numDropped;
-    data_t data;
+    if (!automation_request_in_event_data_poll(&numDropped, &portData)) {
+        return false;
+    }
+    automation_request_in_event_data_receive(numDropped, &portData);
+    return true;
+}
 
-    while (true) {
+port_executive_t portExecutive;
+
+void run_poll(void) {
 
-        bool dataReceived = automation_request_in_event_data_poll(&numDropped, &data);
-        if (dataReceived) {
-            automation_request_in_event_data_receive(numDropped, &data);
-        }
+    port_executive_init(&portExecutive);
+    port_executive_add(&portExecutive, "automation_request_in", PORT_PRIORITY_COMMAND,
+                       service_automation_request_in, NULL, PORT_EXECUTIVE_DRAIN);
 
+    while (true) {
+        port_executive_service(&portExecutive);
         seL4_Yield();
     }
 
@@ -76,6 +100,9 @@ void run_poll(void) {
 
 
 void post_init(void) {
+    if (!validator_compile(&automationRequestValidator, automation_request_schema, automation_request_schema_size)) {
+        printf("%s: automation request schema is malformed, rejecting all\n", get_instance_name()); fflush(stdout);
+    }
     recv_queue_init(&automationRequestInRecvQueue, automation_request_in_queue);
     queue_init(automation_request_out_1_queue);
     queue_init(automation_request_out_2_queue);
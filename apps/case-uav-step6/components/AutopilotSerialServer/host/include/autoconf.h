@@ -0,0 +1,6 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+/* Host build stand-in for the seL4 generated kernel configuration header. */
+#pragma once
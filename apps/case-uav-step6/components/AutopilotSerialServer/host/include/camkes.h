@@ -0,0 +1,54 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+/*
+ * Host build stand-in for the CAmkES generated glue of the AutopilotSerialServer
+ * component.  Only the symbols referenced by the APSS sources are provided; the
+ * definitions live in host/src/camkes_host.c.
+ */
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <sel4/sel4.h>
+#include <utils/util.h>
+#include <queue.h>
+#include <serial_link_stats.h>
+
+#define WEAK __attribute__((weak))
+
+const char *get_instance_name(void);
+
+// has mutex serial
+int serial_lock(void);
+int serial_unlock(void);
+
+// uses Timer timeout
+uint64_t timeout_time(void);
+
+// Dataports
+extern queue_t *mission_command_in_queue;
+extern queue_t *mission_command_priority_in_queue;
+extern queue_t *air_vehicle_state_out_1_queue;
+extern queue_t *air_vehicle_state_out_2_queue;
+extern serial_link_stats_t *serial_link_stats_out;
+
+// Events
+void air_vehicle_state_out_1_SendEvent_emit(void);
+void air_vehicle_state_out_2_SendEvent_emit(void);
+
+// Attributes, writable here so the bench can set them from the command line
+extern int air_vehicle_state_out_1_decimation;
+extern int air_vehicle_state_out_1_min_interval_ms;
+extern int air_vehicle_state_out_1_on_change;
+extern int air_vehicle_state_out_1_max_interval_ms;
+extern int air_vehicle_state_out_2_decimation;
+extern int air_vehicle_state_out_2_min_interval_ms;
+extern int air_vehicle_state_out_2_on_change;
+extern int air_vehicle_state_out_2_max_interval_ms;
+extern int serial_link_stats_period_ms;
+extern int serial_line_rate;
@@ -0,0 +1,10 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+/* Host build stand-in for the CAmkES IO ops interface. */
+#pragma once
+
+#include <platsupport/io.h>
+
+int camkes_io_ops(ps_io_ops_t *io_ops);
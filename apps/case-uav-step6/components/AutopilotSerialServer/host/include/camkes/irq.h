@@ -0,0 +1,8 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+/* Host build stand-in for the CAmkES IRQ interface. */
+#pragma once
+
+#include <platsupport/irq.h>
@@ -0,0 +1,14 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+/* Host build stand-in for the platform support character device interface. */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <platsupport/io.h>
+
+typedef void (*chardev_callback_t)(void *device, int status, size_t bytes_transfered, void *token);
@@ -0,0 +1,17 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+/*
+ * Host build stand-in for the platform support IO ops.  The pty backed plat
+ * needs none of the hardware mapping operations, so these are placeholders.
+ */
+#pragma once
+
+typedef struct ps_irq_ops {
+    void *cookie;
+} ps_irq_ops_t;
+
+typedef struct ps_io_ops {
+    ps_irq_ops_t irq_ops;
+} ps_io_ops_t;
@@ -0,0 +1,10 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+/* Host build stand-in for the platform support IRQ interface. */
+#pragma once
+
+#include <platsupport/io.h>
+
+typedef int (*ps_irq_acknowledge_fn_t)(void *ack_data);
@@ -0,0 +1,17 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+/* Host build stand-in for the seL4 system call interface. */
+#pragma once
+
+#include <sched.h>
+#include <stdint.h>
+
+typedef uintptr_t seL4_Word;
+typedef seL4_Word seL4_CPtr;
+
+static inline void seL4_Yield(void)
+{
+    sched_yield();
+}
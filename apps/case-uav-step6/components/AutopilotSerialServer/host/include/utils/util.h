@@ -0,0 +1,15 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+/* Host build stand-in for the seL4 utility library. */
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define UNUSED __attribute__((unused))
+
+#define ZF_LOGE(...) do { fprintf(stderr, __VA_ARGS__); fprintf(stderr, "\n"); } while (0)
+
+#define ZF_LOGF_IF(cond, ...) do { if (cond) { ZF_LOGE(__VA_ARGS__); abort(); } } while (0)
@@ -0,0 +1,264 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+/*
+ * Simulated autopilot for the APSS host bench.  Streams sentinelized
+ * AirVehicleState frames into the master side of the pty at a configured rate
+ * and consumes the MissionCommand frames the APSS writes back.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <data.h>
+
+#include "lmcp.h"
+#include "MissionCommand.h"
+#include "sentinel_serial_buffer.h"
+#include "host.h"
+
+// Room for the markers, decimal size and decimal checksum around a payload
+#define SENTINEL_OVERHEAD 64
+
+typedef struct sent_time {
+  uint32_t sequence;
+  uint64_t sent_ns;
+} sent_time_t;
+
+static autopilot_sim_config_t config;
+
+static autopilot_sim_stats_t stats;
+
+static sent_time_t sent_times[BENCH_TIMESTAMP_RING_SIZE];
+
+static pthread_t tx_thread;
+static pthread_t rx_thread;
+
+
+static bool write_all(int fd, const uint8_t *buffer, size_t length)
+{
+  while (length > 0) {
+    ssize_t count = write(fd, buffer, length);
+    if (count < 0) {
+      if (errno == EINTR || errno == EAGAIN) {
+        continue;
+      }
+      return false;
+    }
+    buffer += count;
+    length -= (size_t) count;
+  }
+  return true;
+}
+
+
+static void stamp_sequence(uint8_t *message, size_t length, uint32_t sequence)
+{
+  uint8_t *trailer = &message[length - BENCH_SEQUENCE_SIZE];
+  trailer[0] = (uint8_t) (sequence >> 24);
+  trailer[1] = (uint8_t) (sequence >> 16);
+  trailer[2] = (uint8_t) (sequence >>  8);
+  trailer[3] = (uint8_t) (sequence >>  0);
+}
+
+
+// Four 8-octet markers plus the decimal payload size and checksum
+static size_t sentinelized_length(const uint8_t *message, size_t length)
+{
+  uint32_t checksum = sentinel_serial_buffer_calculate_checksum(message, length);
+  return length + 4 * 8 + (size_t) snprintf(NULL, 0, "%zu", length) + (size_t) snprintf(NULL, 0, "%u", checksum);
+}
+
+
+// Alternate between damaging the decimal size field, which the APSS reports as
+// a framing error, and a payload octet, which it reports as a checksum error.
+static void corrupt_frame(uint8_t *frame, size_t frame_length, uint64_t count)
+{
+  if (count % 2 == 0) {
+    frame[8] = 'x';
+  } else {
+    frame[frame_length / 2] ^= 0x01;
+  }
+}
+
+
+static void *tx_thread_main(void *arg)
+{
+  uint8_t *message = malloc(DATA_T_MAX_PAYLOAD);
+  uint8_t *frame = malloc(DATA_T_MAX_PAYLOAD + SENTINEL_OVERHEAD);
+  uint32_t sequence = 0;
+  size_t offset = 0;
+  struct timespec deadline;
+  long period_ns = (config.rate > 0.0) ? (long) (1.0e9 / config.rate) : 0;
+
+  if (message == NULL || frame == NULL) {
+    fprintf(stderr, "autopilot sim: could not allocate frame buffers\n");
+    return NULL;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+  while (1) {
+
+    // Next recorded message, wrapping at the end of the recording
+    size_t remaining = config.frames_size - offset;
+    size_t length = compute_addr_attr_lmcp_message_size((void *) &config.frames[offset], remaining);
+    if (length == 0 || length > DATA_T_MAX_PAYLOAD || length < BENCH_SEQUENCE_SIZE) {
+      if (offset == 0) {
+        fprintf(stderr, "autopilot sim: no address attributed message in recording\n");
+        return NULL;
+      }
+      offset = 0;
+      continue;
+    }
+    memcpy(message, &config.frames[offset], length);
+    offset += length;
+    if (offset >= config.frames_size) {
+      offset = 0;
+    }
+
+    stamp_sequence(message, length, sequence);
+
+    if (!sentinel_serial_buffer_sentinelize_string(frame, DATA_T_MAX_PAYLOAD + SENTINEL_OVERHEAD, message, length)) {
+      continue;
+    }
+    size_t frame_length = sentinelized_length(message, length);
+
+    bool corrupted = config.corrupt_every > 0 && (sequence + 1) % config.corrupt_every == 0;
+    if (corrupted) {
+      corrupt_frame(frame, frame_length, stats.frames_corrupted);
+    }
+
+    sent_time_t *slot = &sent_times[sequence % BENCH_TIMESTAMP_RING_SIZE];
+    __atomic_store_n(&slot->sent_ns, bench_now_ns(), __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->sequence, sequence, __ATOMIC_RELEASE);
+
+    if (!write_all(config.fd, frame, frame_length)) {
+      fprintf(stderr, "autopilot sim: write failed: %s\n", strerror(errno));
+      return NULL;
+    }
+
+    __atomic_add_fetch(&stats.frames_sent, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&stats.octets_sent, frame_length, __ATOMIC_RELAXED);
+    if (corrupted) {
+      __atomic_add_fetch(&stats.frames_corrupted, 1, __ATOMIC_RELAXED);
+    }
+    ++sequence;
+
+    if (period_ns > 0) {
+      deadline.tv_nsec += period_ns;
+      while (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_nsec -= 1000000000L;
+        ++deadline.tv_sec;
+      }
+      clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+    }
+  }
+
+  return NULL;
+}
+
+
+static void handle_mission_command(uint8_t *payload, size_t length)
+{
+  lmcp_object *object = NULL;
+  uint8_t *p = payload;
+
+  if (lmcp_process_msg(&p, length, &object) == 0
+      && object != NULL && object->type == LMCP_MissionCommand_TYPE) {
+    bench_mission_command_received(((MissionCommand *) object)->super.commandid, bench_now_ns());
+    __atomic_add_fetch(&stats.mission_commands_received, 1, __ATOMIC_RELAXED);
+  } else {
+    __atomic_add_fetch(&stats.mission_command_errors, 1, __ATOMIC_RELAXED);
+  }
+
+  if (object != NULL) {
+    lmcp_free(object);
+  }
+}
+
+
+static void *rx_thread_main(void *arg)
+{
+  sentinel_serial_buffer_t *rx_buffer = sentinel_serial_buffer_alloc();
+  data_t *data = malloc(sizeof(data_t));
+  uint8_t buffer[1024];
+
+  if (rx_buffer == NULL || data == NULL) {
+    fprintf(stderr, "autopilot sim: could not allocate receive buffers\n");
+    return NULL;
+  }
+
+  while (1) {
+    ssize_t count = read(config.fd, buffer, sizeof(buffer));
+    if (count < 0) {
+      if (errno == EINTR || errno == EAGAIN) {
+        continue;
+      }
+      fprintf(stderr, "autopilot sim: read failed: %s\n", strerror(errno));
+      return NULL;
+    }
+
+    for (ssize_t index = 0; index < count; ++index) {
+      if (!sentinel_serial_buffer_append_char(rx_buffer, buffer[index])) {
+        __atomic_add_fetch(&stats.mission_command_errors, 1, __ATOMIC_RELAXED);
+      }
+    }
+
+    ssize_t received_size;
+    while ((received_size = sentinel_serial_buffer_get_next_payload_string(rx_buffer, &data->payload[0],
+                                                                           sizeof(data->payload))) > 0
+           || errno != EAGAIN) {
+      if (received_size > 0) {
+        handle_mission_command(&data->payload[0], (size_t) received_size);
+      } else {
+        __atomic_add_fetch(&stats.mission_command_errors, 1, __ATOMIC_RELAXED);
+      }
+    }
+  }
+
+  return NULL;
+}
+
+
+void autopilot_sim_start(const autopilot_sim_config_t *sim_config)
+{
+  config = *sim_config;
+  for (size_t index = 0; index < BENCH_TIMESTAMP_RING_SIZE; ++index) {
+    sent_times[index].sequence = UINT32_MAX;
+  }
+  if (pthread_create(&rx_thread, NULL, rx_thread_main, NULL) != 0
+      || pthread_create(&tx_thread, NULL, tx_thread_main, NULL) != 0) {
+    fprintf(stderr, "autopilot sim: could not start threads\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+
+void autopilot_sim_get_stats(autopilot_sim_stats_t *out)
+{
+  out->frames_sent = __atomic_load_n(&stats.frames_sent, __ATOMIC_RELAXED);
+  out->frames_corrupted = __atomic_load_n(&stats.frames_corrupted, __ATOMIC_RELAXED);
+  out->octets_sent = __atomic_load_n(&stats.octets_sent, __ATOMIC_RELAXED);
+  out->mission_commands_received = __atomic_load_n(&stats.mission_commands_received, __ATOMIC_RELAXED);
+  out->mission_command_errors = __atomic_load_n(&stats.mission_command_errors, __ATOMIC_RELAXED);
+}
+
+
+bool autopilot_sim_sent_time(uint32_t sequence, uint64_t *sent_ns)
+{
+  sent_time_t *slot = &sent_times[sequence % BENCH_TIMESTAMP_RING_SIZE];
+  if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != sequence) {
+    return false;
+  }
+  *sent_ns = __atomic_load_n(&slot->sent_ns, __ATOMIC_RELAXED);
+  return true;
+}
@@ -0,0 +1,494 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+/*
+ * Host runtime for the APSS bench.  Provides the CAmkES glue the APSS sources
+ * expect (dataports, events, mutex, timer, attributes), connects the APSS to
+ * the simulated autopilot through a pty, plays the part of the vmUxAS and
+ * WaypointManager consumers, and reports throughput, error counts, latency
+ * and CPU cost per frame.
+ *
+ * Usage: apss_bench [-r rate] [-d seconds] [-c corrupt_every] [-m mission_ms]
+ *                   [-f recording] [-1 policy] [-2 policy]
+ *
+ * where a policy is "decimation,min_interval_ms,on_change,max_interval_ms".
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <camkes.h>
+#include <camkes/io.h>
+#include <counter.h>
+#include <data.h>
+#include <queue.h>
+
+#include "lmcp.h"
+#include "MissionCommand.h"
+#include "Waypoint.h"
+#include "AddressAttributedMessage.h"
+#include "air_vehicle_state_sample.h"
+#include "host.h"
+
+// APSS entry points
+void pre_init(void);
+void post_init(void);
+int run(void);
+
+#define MISSION_WINDOW_SIZE 15
+#define MAX_LATENCY_SAMPLES (1 << 20)
+
+//------------------------------------------------------------------------------
+// CAmkES glue
+
+static queue_t mission_command_in_dataport;
+static queue_t mission_command_priority_in_dataport;
+static queue_t air_vehicle_state_out_1_dataport;
+static queue_t air_vehicle_state_out_2_dataport;
+static serial_link_stats_t serial_link_stats_dataport;
+
+queue_t *mission_command_in_queue = &mission_command_in_dataport;
+queue_t *mission_command_priority_in_queue = &mission_command_priority_in_dataport;
+queue_t *air_vehicle_state_out_1_queue = &air_vehicle_state_out_1_dataport;
+queue_t *air_vehicle_state_out_2_queue = &air_vehicle_state_out_2_dataport;
+serial_link_stats_t *serial_link_stats_out = &serial_link_stats_dataport;
+
+int air_vehicle_state_out_1_decimation = 1;
+int air_vehicle_state_out_1_min_interval_ms = 0;
+int air_vehicle_state_out_1_on_change = 0;
+int air_vehicle_state_out_1_max_interval_ms = 0;
+int air_vehicle_state_out_2_decimation = 1;
+int air_vehicle_state_out_2_min_interval_ms = 0;
+int air_vehicle_state_out_2_on_change = 0;
+int air_vehicle_state_out_2_max_interval_ms = 0;
+int serial_link_stats_period_ms = 1000;
+int serial_line_rate = 115200;
+
+static pthread_mutex_t serial_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+const char *get_instance_name(void)
+{
+  return "autopilot_serial_server";
+}
+
+int serial_lock(void)
+{
+  return pthread_mutex_lock(&serial_mutex);
+}
+
+int serial_unlock(void)
+{
+  return pthread_mutex_unlock(&serial_mutex);
+}
+
+uint64_t bench_now_ns(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+}
+
+uint64_t timeout_time(void)
+{
+  return bench_now_ns();
+}
+
+void air_vehicle_state_out_1_SendEvent_emit(void)
+{
+}
+
+void air_vehicle_state_out_2_SendEvent_emit(void)
+{
+}
+
+int camkes_io_ops(ps_io_ops_t *io_ops)
+{
+  memset(io_ops, 0, sizeof(*io_ops));
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Serial receive error accounting.  The bench links with
+// --wrap=autopilot_serial_server_read_serial so every result the APSS sees is
+// counted here.
+
+ssize_t __real_autopilot_serial_server_read_serial(void *data, size_t length);
+
+static counter_t framing_errors;
+static counter_t checksum_errors;
+static counter_t oversize_errors;
+
+ssize_t __wrap_autopilot_serial_server_read_serial(void *data, size_t length)
+{
+  ssize_t result = __real_autopilot_serial_server_read_serial(data, length);
+  if (result < 0) {
+    int saved_errno = errno;
+    switch (saved_errno) {
+    case EINVAL:
+      __atomic_add_fetch(&framing_errors, 1, __ATOMIC_RELAXED);
+      break;
+    case EIO:
+      __atomic_add_fetch(&checksum_errors, 1, __ATOMIC_RELAXED);
+      break;
+    case EFAULT:
+      __atomic_add_fetch(&oversize_errors, 1, __ATOMIC_RELAXED);
+      break;
+    default:
+      break;
+    }
+    errno = saved_errno;
+  }
+  return result;
+}
+
+//------------------------------------------------------------------------------
+// Latency statistics
+
+typedef struct latency_stats {
+  const char *name;
+  counter_t received;
+  counter_t dropped;
+  counter_t unmatched;
+  size_t samples;
+  uint64_t *sample;
+} latency_stats_t;
+
+static void latency_init(latency_stats_t *stats, const char *name)
+{
+  memset(stats, 0, sizeof(*stats));
+  stats->name = name;
+  stats->sample = calloc(MAX_LATENCY_SAMPLES, sizeof(uint64_t));
+}
+
+static void latency_add(latency_stats_t *stats, uint64_t latency_ns)
+{
+  if (stats->sample != NULL && stats->samples < MAX_LATENCY_SAMPLES) {
+    stats->sample[stats->samples++] = latency_ns;
+  }
+}
+
+static int compare_uint64(const void *a, const void *b)
+{
+  uint64_t x = *(const uint64_t *) a;
+  uint64_t y = *(const uint64_t *) b;
+  return (x > y) - (x < y);
+}
+
+static void latency_report(latency_stats_t *stats, double seconds)
+{
+  printf("  %-16s %10" PRIcounter " msgs %10.1f msg/s, dropped %" PRIcounter ", unmatched %" PRIcounter "\n",
+         stats->name, stats->received, stats->received / seconds, stats->dropped, stats->unmatched);
+  if (stats->samples > 0) {
+    qsort(stats->sample, stats->samples, sizeof(uint64_t), compare_uint64);
+    printf("  %-16s latency us: min %.1f, p50 %.1f, p99 %.1f, max %.1f\n", "",
+           stats->sample[0] / 1000.0,
+           stats->sample[stats->samples / 2] / 1000.0,
+           stats->sample[(stats->samples * 99) / 100] / 1000.0,
+           stats->sample[stats->samples - 1] / 1000.0);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Consumers of the APSS air vehicle state outputs
+
+static uint32_t read_sequence(data_t *data)
+{
+  size_t length = compute_addr_attr_lmcp_message_size(&data->payload[0], sizeof(data->payload));
+  if (length < BENCH_SEQUENCE_SIZE) {
+    return UINT32_MAX;
+  }
+  const uint8_t *trailer = &data->payload[length - BENCH_SEQUENCE_SIZE];
+  return ((uint32_t) trailer[0] << 24) | ((uint32_t) trailer[1] << 16)
+    | ((uint32_t) trailer[2] << 8) | ((uint32_t) trailer[3] << 0);
+}
+
+static void consume(recv_queue_t *recv_queue, latency_stats_t *stats, data_t *data)
+{
+  counter_t numDropped;
+  while (queue_dequeue(recv_queue, &numDropped, data)) {
+    uint64_t now = bench_now_ns();
+    uint64_t sent_ns;
+    stats->dropped += numDropped;
+    ++stats->received;
+    if (autopilot_sim_sent_time(read_sequence(data), &sent_ns)) {
+      latency_add(stats, now - sent_ns);
+    } else {
+      ++stats->unmatched;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Mission commands, injected as the WaypointManager would send them
+
+static const char mission_command_attributes[] = "afrl.cmasi.MissionCommand$lmcp|afrl.cmasi.MissionCommand||400|63$";
+
+static uint64_t mission_command_sent_ns[BENCH_TIMESTAMP_RING_SIZE];
+
+static latency_stats_t mission_command_stats;
+
+static pthread_mutex_t mission_command_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void inject_mission_command(int64_t command_id, data_t *data)
+{
+  MissionCommand *missionCommand = NULL;
+  Waypoint *waypoint = NULL;
+  lmcp_init_MissionCommand(&missionCommand);
+  lmcp_init_Waypoint(&waypoint);
+
+  waypoint->number = 1;
+  waypoint->nextwaypoint = 1;
+  missionCommand->super.vehicleid = 400;
+  missionCommand->super.commandid = command_id;
+  missionCommand->super.status = 1;
+  missionCommand->waypointlist_ai.length = MISSION_WINDOW_SIZE;
+  missionCommand->waypointlist = malloc(sizeof(Waypoint *) * MISSION_WINDOW_SIZE);
+  for (int i = 0; i < MISSION_WINDOW_SIZE; i++) {
+    missionCommand->waypointlist[i] = waypoint;
+  }
+  missionCommand->firstwaypoint = 1;
+
+  AddressAttributedMessage *addressAttributedMessage = NULL;
+  lmcp_init_AddressAttributedMessage(&addressAttributedMessage);
+  addressAttributedMessage->attributes = (char *) mission_command_attributes;
+  addressAttributedMessage->lmcp_obj = (lmcp_object *) missionCommand;
+
+  memset(data, 0, sizeof(*data));
+  lmcp_pack_AddressAttributedMessage(data->payload, addressAttributedMessage);
+
+  pthread_mutex_lock(&mission_command_mutex);
+  mission_command_sent_ns[command_id % BENCH_TIMESTAMP_RING_SIZE] = bench_now_ns();
+  pthread_mutex_unlock(&mission_command_mutex);
+  queue_enqueue(mission_command_in_queue, data);
+
+  free(missionCommand->waypointlist);
+  missionCommand->waypointlist = NULL;
+  missionCommand->waypointlist_ai.length = 0;
+  lmcp_free_MissionCommand(missionCommand, 1);
+  lmcp_free_Waypoint(waypoint, 1);
+  lmcp_free_AddressAttributedMessage(addressAttributedMessage, 1);
+}
+
+void bench_mission_command_received(int64_t command_id, uint64_t received_ns)
+{
+  pthread_mutex_lock(&mission_command_mutex);
+  ++mission_command_stats.received;
+  latency_add(&mission_command_stats,
+              received_ns - mission_command_sent_ns[command_id % BENCH_TIMESTAMP_RING_SIZE]);
+  pthread_mutex_unlock(&mission_command_mutex);
+}
+
+//------------------------------------------------------------------------------
+// Bench
+
+typedef struct bench_config {
+  double seconds;
+  unsigned mission_period_ms;
+} bench_config_t;
+
+static bench_config_t bench;
+
+static uint64_t thread_cpu_ns(pthread_t thread)
+{
+  clockid_t clock;
+  struct timespec cpu;
+  if (pthread_getcpuclockid(thread, &clock) != 0 || clock_gettime(clock, &cpu) != 0) {
+    return 0;
+  }
+  return (uint64_t) cpu.tv_sec * 1000000000ULL + (uint64_t) cpu.tv_nsec;
+}
+
+static pthread_t apss_thread;
+
+static void *consumer_thread_main(void *arg)
+{
+  recv_queue_t out_1;
+  recv_queue_t out_2;
+  latency_stats_t out_1_stats;
+  latency_stats_t out_2_stats;
+  data_t *data = malloc(sizeof(data_t));
+  int64_t command_id = 1;
+
+  recv_queue_init(&out_1, air_vehicle_state_out_1_queue);
+  recv_queue_init(&out_2, air_vehicle_state_out_2_queue);
+  latency_init(&out_1_stats, "out_1 (vmUxAS)");
+  latency_init(&out_2_stats, "out_2 (WPM)");
+
+  uint64_t start = bench_now_ns();
+  uint64_t apss_cpu_start = thread_cpu_ns(apss_thread) + thread_cpu_ns(plat_pty_irq_thread());
+  uint64_t end = start + (uint64_t) (bench.seconds * 1.0e9);
+  uint64_t next_mission_command = start + (uint64_t) bench.mission_period_ms * 1000000ULL;
+
+  while (bench_now_ns() < end) {
+    consume(&out_1, &out_1_stats, data);
+    consume(&out_2, &out_2_stats, data);
+    if (bench.mission_period_ms > 0 && bench_now_ns() >= next_mission_command) {
+      inject_mission_command(command_id++, data);
+      next_mission_command += (uint64_t) bench.mission_period_ms * 1000000ULL;
+    }
+    sched_yield();
+  }
+
+  double seconds = (bench_now_ns() - start) / 1.0e9;
+  uint64_t apss_cpu = thread_cpu_ns(apss_thread) + thread_cpu_ns(plat_pty_irq_thread()) - apss_cpu_start;
+  autopilot_sim_stats_t sim;
+  autopilot_sim_get_stats(&sim);
+
+  printf("\napss bench: %.2f s\n", seconds);
+  printf("  %-16s %10" PRIu64 " frames %9.1f frame/s, %.1f KiB/s, corrupted %" PRIu64 "\n", "autopilot tx",
+         sim.frames_sent, sim.frames_sent / seconds, sim.octets_sent / seconds / 1024.0, sim.frames_corrupted);
+  latency_report(&out_1_stats, seconds);
+  latency_report(&out_2_stats, seconds);
+  printf("  %-16s framing %" PRIcounter ", checksum %" PRIcounter ", oversize %" PRIcounter "\n", "serial rx errors",
+         __atomic_load_n(&framing_errors, __ATOMIC_RELAXED),
+         __atomic_load_n(&checksum_errors, __ATOMIC_RELAXED),
+         __atomic_load_n(&oversize_errors, __ATOMIC_RELAXED));
+  serial_link_stats_t link;
+  if (serial_link_stats_read(serial_link_stats_out, &link)) {
+    printf("  %-16s rx %" PRIserial_link_counter " octets, %" PRIserial_link_counter " frames, "
+           "resync discards %" PRIserial_link_counter ", overflow drops %" PRIserial_link_counter
+           ", high water %" PRIserial_link_counter "; tx %" PRIserial_link_counter " octets, high water %"
+           PRIserial_link_counter " (published)\n", "serial link",
+           link.rx.octets_in, link.rx.frames_out, link.rx.resync_discards, link.rx.overflow_drops,
+           link.rx.high_water, link.tx.octets_out, link.tx.high_water);
+  }
+  pthread_mutex_lock(&mission_command_mutex);
+  printf("  %-16s injected %" PRId64 ", decode errors %" PRIu64 "\n", "mission commands",
+         command_id - 1, sim.mission_command_errors);
+  latency_report(&mission_command_stats, seconds);
+  pthread_mutex_unlock(&mission_command_mutex);
+  printf("  %-16s %.1f ms total, %.2f us per received frame\n", "apss cpu",
+         apss_cpu / 1.0e6, (out_1_stats.received > 0) ? apss_cpu / 1.0e3 / out_1_stats.received : 0.0);
+  fflush(stdout);
+
+  exit(EXIT_SUCCESS);
+  return NULL;
+}
+
+static void parse_policy(const char *arg, int *decimation, int *min_interval_ms, int *on_change, int *max_interval_ms)
+{
+  if (sscanf(arg, "%d,%d,%d,%d", decimation, min_interval_ms, on_change, max_interval_ms) != 4) {
+    fprintf(stderr, "apss bench: policy must be decimation,min_interval_ms,on_change,max_interval_ms\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+static uint8_t *read_recording(const char *path, size_t *size)
+{
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    fprintf(stderr, "apss bench: could not open %s: %s\n", path, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  fseek(file, 0, SEEK_END);
+  long length = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  uint8_t *buffer = malloc(length > 0 ? (size_t) length : 1);
+  if (buffer == NULL || length <= 0 || fread(buffer, 1, (size_t) length, file) != (size_t) length) {
+    fprintf(stderr, "apss bench: could not read %s\n", path);
+    exit(EXIT_FAILURE);
+  }
+  fclose(file);
+  *size = (size_t) length;
+  return buffer;
+}
+
+static int open_pty(int *slave_fd)
+{
+  int master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master_fd < 0 || grantpt(master_fd) != 0 || unlockpt(master_fd) != 0) {
+    return -1;
+  }
+  *slave_fd = open(ptsname(master_fd), O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (*slave_fd < 0) {
+    return -1;
+  }
+  // Binary transport: no line discipline cooking on either side
+  struct termios tio;
+  tcgetattr(*slave_fd, &tio);
+  cfmakeraw(&tio);
+  tcsetattr(*slave_fd, TCSANOW, &tio);
+  tcgetattr(master_fd, &tio);
+  cfmakeraw(&tio);
+  tcsetattr(master_fd, TCSANOW, &tio);
+  return master_fd;
+}
+
+int main(int argc, char *argv[])
+{
+  autopilot_sim_config_t sim = {
+    .rate = 50.0,
+    .corrupt_every = 0,
+    .frames = air_vehicle_state_sample,
+    .frames_size = air_vehicle_state_sample_size,
+  };
+  bench.seconds = 10.0;
+  bench.mission_period_ms = 1000;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "r:d:c:m:f:1:2:")) != -1) {
+    switch (opt) {
+    case 'r':
+      sim.rate = atof(optarg);
+      break;
+    case 'd':
+      bench.seconds = atof(optarg);
+      break;
+    case 'c':
+      sim.corrupt_every = (unsigned) atoi(optarg);
+      break;
+    case 'm':
+      bench.mission_period_ms = (unsigned) atoi(optarg);
+      break;
+    case 'f':
+      sim.frames = read_recording(optarg, &sim.frames_size);
+      break;
+    case '1':
+      parse_policy(optarg, &air_vehicle_state_out_1_decimation, &air_vehicle_state_out_1_min_interval_ms,
+                   &air_vehicle_state_out_1_on_change, &air_vehicle_state_out_1_max_interval_ms);
+      break;
+    case '2':
+      parse_policy(optarg, &air_vehicle_state_out_2_decimation, &air_vehicle_state_out_2_min_interval_ms,
+                   &air_vehicle_state_out_2_on_change, &air_vehicle_state_out_2_max_interval_ms);
+      break;
+    default:
+      fprintf(stderr, "usage: %s [-r rate] [-d seconds] [-c corrupt_every] [-m mission_ms] [-f recording]"
+              " [-1 policy] [-2 policy]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  int slave_fd;
+  sim.fd = open_pty(&slave_fd);
+  if (sim.fd < 0) {
+    fprintf(stderr, "apss bench: could not open pseudo-terminal: %s\n", strerror(errno));
+    return EXIT_FAILURE;
+  }
+  plat_pty_attach(slave_fd);
+
+  latency_init(&mission_command_stats, "mission commands");
+
+  apss_thread = pthread_self();
+  pre_init();
+  post_init();
+  autopilot_sim_start(&sim);
+
+  pthread_t consumer_thread;
+  if (pthread_create(&consumer_thread, NULL, consumer_thread_main, NULL) != 0) {
+    fprintf(stderr, "apss bench: could not start consumer\n");
+    return EXIT_FAILURE;
+  }
+
+  return run();
+}
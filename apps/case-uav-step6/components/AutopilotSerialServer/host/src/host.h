@@ -0,0 +1,48 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+#pragma once
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Sequence numbers are carried in the LMCP checksum trailer of each frame, so
+// the bench can match a delivered message with the time it was sent.  Nothing
+// on the APSS path validates the LMCP checksum.
+#define BENCH_SEQUENCE_SIZE 4
+
+// Send timestamps are kept in a ring indexed by sequence number
+#define BENCH_TIMESTAMP_RING_SIZE 4096
+
+// plat_pty.c
+void plat_pty_attach(int fd);
+pthread_t plat_pty_irq_thread(void);
+
+// camkes_host.c
+uint64_t bench_now_ns(void);
+
+// autopilot_sim.c
+typedef struct autopilot_sim_config {
+  int fd;
+  double rate;                  // frames per second, 0 for as fast as the link allows
+  unsigned corrupt_every;       // corrupt every Nth frame, 0 never
+  const uint8_t *frames;        // concatenated address attributed messages
+  size_t frames_size;
+} autopilot_sim_config_t;
+
+typedef struct autopilot_sim_stats {
+  uint64_t frames_sent;
+  uint64_t frames_corrupted;
+  uint64_t octets_sent;
+  uint64_t mission_commands_received;
+  uint64_t mission_command_errors;
+} autopilot_sim_stats_t;
+
+void autopilot_sim_start(const autopilot_sim_config_t *config);
+void autopilot_sim_get_stats(autopilot_sim_stats_t *stats);
+bool autopilot_sim_sent_time(uint32_t sequence, uint64_t *sent_ns);
+
+// Mission command latency is reported by the simulator back to the host glue
+void bench_mission_command_received(int64_t command_id, uint64_t received_ns);
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+/*
+ * Host implementation of the APSS plat interface backed by a pseudo-terminal.
+ * The slave side of the pty stands in for the UART.  A reader thread waits
+ * for input and calls the APSS interrupt handler, as the UART interrupt does
+ * on target.
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <utils/util.h>
+
+#include "plat.h"
+#include "serial.h"
+#include "host.h"
+
+static int serial_fd = -1;
+
+static pthread_t irq_thread;
+
+void plat_pty_attach(int fd)
+{
+    serial_fd = fd;
+}
+
+pthread_t plat_pty_irq_thread(void)
+{
+    return irq_thread;
+}
+
+ssize_t plat_serial_write(void *buf, size_t buf_size, chardev_callback_t cb, void *token)
+{
+    return write(serial_fd, buf, buf_size);
+}
+
+ssize_t plat_serial_read(void *buf, size_t buf_size, chardev_callback_t cb, void *token)
+{
+    ssize_t res = read(serial_fd, buf, buf_size);
+    if (res < 0 && errno == EAGAIN) {
+        res = 0;
+    }
+    return res;
+}
+
+void plat_serial_interrupt(handle_char_fn handle_char)
+{
+    uint8_t buffer[256];
+    ssize_t count;
+    while ((count = read(serial_fd, buffer, sizeof(buffer))) > 0) {
+        for (ssize_t index = 0; index < count; ++index) {
+            handle_char(buffer[index]);
+        }
+    }
+}
+
+void plat_serial_putchar(int c)
+{
+    uint8_t octet = (uint8_t) c;
+    while (write(serial_fd, &octet, 1) < 0 && errno == EAGAIN) {
+        struct pollfd pfd = { .fd = serial_fd, .events = POLLOUT };
+        poll(&pfd, 1, -1);
+    }
+}
+
+void plat_pre_init(ps_io_ops_t *io_ops)
+{
+    if (serial_fd < 0) {
+        ZF_LOGE("No pseudo-terminal attached");
+    }
+}
+
+static int irq_acknowledge(void *ack_data)
+{
+    return 0;
+}
+
+static void *irq_thread_main(void *arg)
+{
+    struct pollfd pfd = { .fd = serial_fd, .events = POLLIN };
+    while (1) {
+        if (poll(&pfd, 1, -1) > 0) {
+            autopilot_serial_server_irq_handle(NULL, irq_acknowledge, NULL);
+        }
+    }
+    return NULL;
+}
+
+void plat_post_init(ps_irq_ops_t *irq_ops)
+{
+    int error = pthread_create(&irq_thread, NULL, irq_thread_main, NULL);
+    ZF_LOGF_IF(error, "Failed to create serial irq thread");
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/**
+ * Address attributed LMCP message recorded from the autopilot simulation.
+ * By default this is an AirVehicleState, with an OperatingRegion available
+ * by undefining AIR_VEHICLE_STATE_MESSAGE in air_vehicle_state_sample.c.
+ * Used for bench testing the serial path without live autopilot traffic.
+ */
+extern const uint8_t air_vehicle_state_sample[];
+
+extern const size_t air_vehicle_state_sample_size;
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "counter.h"
+
+
+/**
+ * Per-consumer forwarding policy for AirVehicleState messages received from
+ * the autopilot.  Each output port of the APSS gets its own policy so that the
+ * fan-out cost matches what the consumer actually needs:
+ *
+ *     decimation             forward only every Nth candidate message (0 or 1
+ *                            forwards every message)
+ *     min_interval_ns        never forward two messages closer together than
+ *                            this (0 disables)
+ *     on_change_waypoint     forward only when the EntityState currentwaypoint
+ *                            differs from the last forwarded value
+ *     max_interval_ns        with on_change_waypoint, still forward an
+ *                            unchanged message once this much time has passed
+ *                            so the consumer sees a heartbeat (0 disables)
+ *
+ * The checks are applied in the order min interval, on-change, decimation.
+ * A message that fails to decode is always forwarded when on-change filtering
+ * is enabled, leaving the decision to the consumer.
+ */
+typedef struct avs_forward_policy {
+  // Configuration
+  uint32_t decimation;
+  uint64_t min_interval_ns;
+  bool on_change_waypoint;
+  uint64_t max_interval_ns;
+
+  // State
+  uint32_t decimation_count;
+  bool forwarded_any;
+  uint64_t last_forward_ns;
+  int64_t last_waypoint;
+
+  // Statistics
+  counter_t forwarded;
+  counter_t suppressed;
+} avs_forward_policy_t;
+
+
+void avs_forward_policy_init(avs_forward_policy_t *policy, uint32_t decimation, uint64_t min_interval_ns,
+                             bool on_change_waypoint, uint64_t max_interval_ns);
+
+
+bool avs_forward_policy_should_forward(avs_forward_policy_t *policy, uint64_t now_ns,
+                                       uint8_t *payload, size_t length);
+
+
+/**
+ * Extract the currentwaypoint field of an address attributed AirVehicleState
+ * message, read in place without decoding the message.  Returns false if the
+ * payload is not an AirVehicleState, or one whose PayloadStateList holds
+ * subtypes of PayloadState.  The fields after currentwaypoint are not checked.
+ */
+bool avs_forward_policy_current_waypoint(uint8_t *payload, size_t length, int64_t *waypoint);
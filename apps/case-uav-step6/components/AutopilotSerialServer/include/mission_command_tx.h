@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <data.h>
+
+#include "counter.h"
+
+
+/**
+ * Staging area for MissionCommands waiting to go out on the serial link.
+ *
+ * Only one frame is in the TX sentinel serial buffer at a time.  Commands
+ * that arrive while a frame is on the wire wait here, one slot per vehicle.
+ * A newer command for a vehicle that still has an unsent command replaces
+ * it: the autopilot would discard the older window anyway, and sending it
+ * costs link time.  A routine command is dropped, though, while the vehicle
+ * has an unsent priority command (return home).  Priority commands go out
+ * before any routine command, oldest first within each class.
+ */
+#define MISSION_COMMAND_TX_SLOTS 4
+
+// Writes of a command to the TX buffer that may fail before it is dropped
+#define MISSION_COMMAND_TX_ATTEMPTS 3
+
+
+typedef struct mission_command_tx_slot {
+  bool pending;
+  bool priority;
+  int64_t vehicle_id;
+  int64_t command_id;
+  counter_t sequence;
+  uint32_t attempts;
+  size_t length;
+  uint8_t payload[DATA_T_MAX_PAYLOAD];
+} mission_command_tx_slot_t;
+
+
+typedef struct mission_command_tx {
+  mission_command_tx_slot_t slot[MISSION_COMMAND_TX_SLOTS];
+  counter_t next_sequence;
+
+  // Statistics
+  counter_t submitted;
+  counter_t superseded;
+  counter_t dropped;
+  counter_t sent;
+  counter_t priority_sent;
+} mission_command_tx_t;
+
+
+void mission_command_tx_init(mission_command_tx_t *ctx);
+
+
+/**
+ * Read the commandid and vehicleid of an address attributed MissionCommand
+ * directly from the wire format.  Returns false if the payload is not a
+ * MissionCommand.
+ */
+bool mission_command_tx_decode_ids(const uint8_t *payload, size_t length, int64_t *command_id, int64_t *vehicle_id);
+
+
+/**
+ * Stage a MissionCommand, superseding any unsent command for the same
+ * vehicle.  Returns false, and counts a drop, if the payload is not a
+ * MissionCommand, if it is routine and the vehicle has an unsent priority
+ * command, or if there is no free slot.
+ */
+bool mission_command_tx_submit(mission_command_tx_t *ctx, const uint8_t *payload, size_t length, bool priority);
+
+
+/**
+ * The next command to transmit, left staged until mission_command_tx_done
+ * reports it written.  The returned slot stays valid until then or the next
+ * call to mission_command_tx_submit.
+ */
+mission_command_tx_slot_t *mission_command_tx_next(mission_command_tx_t *ctx);
+
+
+/**
+ * Report whether the command mission_command_tx_next returned was written to
+ * the TX buffer.  A written command is cleared and counted as sent.  One that
+ * was not stays staged to be tried again, unless that was its
+ * MISSION_COMMAND_TX_ATTEMPTS-th failure, when it is cleared and counted as a
+ * drop.
+ */
+void mission_command_tx_done(mission_command_tx_t *ctx, mission_command_tx_slot_t *slot, bool written);
@@ -6,6 +6,7 @@
 #include <sys/types.h>
 
 #include "counter.h"
+#include "serial_link_stats.h"
 
 
 /**
@@ -40,6 +41,10 @@
 typedef struct sentinel_serial_buffer {
   _Atomic counter_t write_counter;
   _Atomic counter_t read_counter;
+  // Link statistics.  The writer side (octets_in, frames_in, overflow_drops,
+  // high_water) and the reader side (everything else) are each updated by a
+  // single thread, so no field has two writers.
+  serial_link_counters_t stats;
   uint8_t data[SENTINEL_SERIAL_BUFFER_RING_SIZE];
 } sentinel_serial_buffer_t;
 
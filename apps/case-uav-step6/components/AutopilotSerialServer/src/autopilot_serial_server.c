@@ -4,6 +4,7 @@
 
 #include <ctype.h>
 #include <errno.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -15,48 +16,14 @@
 #include <queue.h>
 
 #include "hexdump.h"
+#include "lmcp.h"
 #include "serial.h"
 #include "sentinel_serial_buffer.h"
-
-
-size_t compute_addr_attr_lmcp_message_size(void *buffer, size_t buffer_length)
-{
-  static const uint8_t addr_attr_delim = '$';
-  static const uint8_t field_delim = '|';
-
-  void *end_of_address_delim = memchr(buffer, addr_attr_delim, buffer_length);
-  if (end_of_address_delim == NULL) {
-    errno = -1;
-    return 0;
-  }
-  ssize_t end_of_address_delim_offset = end_of_address_delim - buffer;
-  
-  void *end_of_attr_delim = memchr(end_of_address_delim + 1, addr_attr_delim, buffer_length - end_of_address_delim_offset - 1);
-  if (end_of_attr_delim == NULL) {
-    errno = -2;
-    return 0;
-  }
-  ssize_t end_of_attr_delim_offset = end_of_attr_delim - buffer;
-  
-  const size_t lmcp_control_string_size = 4;
-  const size_t checksum_size = 4;
-
-  uint8_t *lmcp_message_size_pos = end_of_attr_delim + sizeof(addr_attr_delim) + lmcp_control_string_size;
-  size_t lmcp_message_size = ((size_t) lmcp_message_size_pos[0] << 24)
-    + ((size_t) lmcp_message_size_pos[1] << 16)
-    + ((size_t) lmcp_message_size_pos[2] <<  8)
-    + ((size_t) lmcp_message_size_pos[3] <<  0);
-    
-  if (buffer + buffer_length < ((void *) lmcp_message_size_pos) + lmcp_message_size + checksum_size) {
-    fprintf(stdout, "apss: compute_addr_attr_lmcp_message_size: EoAddr %zu, EoAttr %zu, LMCP sz %zu\n",
-	    end_of_address_delim_offset, end_of_attr_delim_offset, lmcp_message_size); fflush(stdout);
-    errno = -4;
-    return 0;
-  }
-
-  errno = 0;
-  return ((size_t) ((void *) lmcp_message_size_pos - buffer)) + lmcp_control_string_size + lmcp_message_size + checksum_size;
-}
+#include "avs_forward_policy.h"
+#include "air_vehicle_state_sample.h"
+#include "mission_command_tx.h"
+#include "serial_link_stats.h"
+#include "port_executive.h"
 
 
 // User specified input data receive handler for AADL Input Event Data Port (in) named
@@ -99,6 +66,21 @@ bool mission_command_in_event_data_poll(counter_t *numDropped, data_t *data) {
 //     while (! mission_command_in_SendEvent_reg_callback(&mission_command_in_handler, NULL));
 // }
 
+//------------------------------------------------------------------------------
+// Implementation of AADL Input Event Data Port (in) named "mission_command_priority_in"
+//
+// Return home commands from the WaypointManager arrive here and are sent to
+// the autopilot ahead of any routine mission command.
+
+static mission_command_tx_t missionCommandTx;
+
+recv_queue_t missionCommandPriorityInRecvQueue;
+
+// Assumption: only one thread is calling this and/or reading mission_command_priority_in_recv_counter.
+bool mission_command_priority_in_event_data_poll(counter_t *numDropped, data_t *data) {
+  return queue_dequeue(&missionCommandPriorityInRecvQueue, numDropped, data);
+}
+
 //--
 
 void done_emit_underlying(void) WEAK;
@@ -134,6 +116,76 @@ void air_vehicle_state_out_2_event_data_send(data_t *data) {
   done_emit();
 }
 
+//------------------------------------------------------------------------------
+// Per-consumer forwarding policies for the air vehicle state outputs.  These
+// are configured from the component attributes in post_init.
+
+static avs_forward_policy_t airVehicleStateOut1Policy;
+static avs_forward_policy_t airVehicleStateOut2Policy;
+
+#define MS_TO_NS(ms) ((uint64_t) (ms) * 1000000ULL)
+
+static void air_vehicle_state_forward(data_t *data, size_t length) {
+  uint64_t now = timeout_time();
+
+  if (avs_forward_policy_should_forward(&airVehicleStateOut1Policy, now, &data->payload[0], length)) {
+    air_vehicle_state_out_1_event_data_send(data);
+  }
+
+  if (avs_forward_policy_should_forward(&airVehicleStateOut2Policy, now, &data->payload[0], length)) {
+    air_vehicle_state_out_2_event_data_send(data);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Serial link statistics
+//
+// The receive and transmit buffer counters are published to the
+// serial_link_stats_out dataport every serial_link_stats_period_ms.  A summary
+// is logged for any window in which the link lost or rejected data.  The line
+// utilization tells the two causes apart: overflow drops at high utilization
+// mean the link is saturated, at low utilization that the APSS fell behind.
+
+static uint64_t serialLinkStatsNextPublish = 0;
+
+static void serial_link_stats_log(const serial_link_stats_t *stats) {
+  fprintf(stdout, "apss: link rx %" PRIu32 " B/s (%" PRIu32 ".%" PRIu32 "%%) %" PRIu32 " frames/s, "
+	  "%" PRIu32 " discarded B/s, %" PRIu32 " errors/s, high water %" PRIserial_link_counter "; "
+	  "tx %" PRIu32 " B/s (%" PRIu32 ".%" PRIu32 "%%), %" PRIu32 " discarded B/s, high water %" PRIserial_link_counter "\n",
+	  stats->rx_rate.octets, stats->rx_rate.utilization / 10, stats->rx_rate.utilization % 10,
+	  stats->rx_rate.frames, stats->rx_rate.discards, stats->rx_rate.errors, stats->rx.high_water,
+	  stats->tx_rate.octets, stats->tx_rate.utilization / 10, stats->tx_rate.utilization % 10,
+	  stats->tx_rate.discards, stats->tx.high_water);
+  fflush(stdout);
+}
+
+static void serial_link_stats_update(void) {
+  if (serial_link_stats_period_ms <= 0) {
+    return;
+  }
+
+  uint64_t now = timeout_time();
+  if (now < serialLinkStatsNextPublish) {
+    return;
+  }
+  serialLinkStatsNextPublish = now + MS_TO_NS(serial_link_stats_period_ms);
+
+  serial_link_stats_t update;
+  memset(&update, 0, sizeof(update));
+  update.time_ns = now;
+  update.line_rate = (uint32_t) serial_line_rate;
+  autopilot_serial_server_get_link_counters(&update.rx, &update.tx);
+  update.mission_commands_superseded = missionCommandTx.superseded;
+  update.mission_commands_dropped = missionCommandTx.dropped;
+  update.air_vehicle_states_suppressed = airVehicleStateOut1Policy.suppressed + airVehicleStateOut2Policy.suppressed;
+  serial_link_stats_publish(serial_link_stats_out, &update);
+
+  if (serial_link_stats_out->rx_rate.discards > 0 || serial_link_stats_out->rx_rate.errors > 0
+      || serial_link_stats_out->tx_rate.discards > 0) {
+    serial_link_stats_log(serial_link_stats_out);
+  }
+}
+
 //------------------------------------------------------------------------------
 // Testing
 
@@ -148,110 +200,134 @@ void post_init(void) {
   queue_init(air_vehicle_state_out_1_queue);
   queue_init(air_vehicle_state_out_2_queue);
   recv_queue_init(&missionCommandInRecvQueue, mission_command_in_queue);
+  recv_queue_init(&missionCommandPriorityInRecvQueue, mission_command_priority_in_queue);
+  mission_command_tx_init(&missionCommandTx);
+  avs_forward_policy_init(&airVehicleStateOut1Policy, air_vehicle_state_out_1_decimation,
+                          MS_TO_NS(air_vehicle_state_out_1_min_interval_ms),
+                          air_vehicle_state_out_1_on_change, MS_TO_NS(air_vehicle_state_out_1_max_interval_ms));
+  avs_forward_policy_init(&airVehicleStateOut2Policy, air_vehicle_state_out_2_decimation,
+                          MS_TO_NS(air_vehicle_state_out_2_min_interval_ms),
+                          air_vehicle_state_out_2_on_change, MS_TO_NS(air_vehicle_state_out_2_max_interval_ms));
 }
 
-static const char message[] = {
-#define AIR_VEHICLE_STATE_MESSAGE
-#ifdef AIR_VEHICLE_STATE_MESSAGE
-  0x61,0x66,0x72,0x6C,0x2E,0x63,0x6D,0x61,0x73,0x69,0x2E,0x41,0x69,0x72,0x56,0x65,
-  0x68,0x69,0x63,0x6C,0x65,0x53,0x74,0x61,0x74,0x65,0x24,0x6C,0x6D,0x63,0x70,0x7C,
-  0x61,0x66,0x72,0x6C,0x2E,0x63,0x6D,0x61,0x73,0x69,0x2E,0x41,0x69,0x72,0x56,0x65,
-  0x68,0x69,0x63,0x6C,0x65,0x53,0x74,0x61,0x74,0x65,0x7C,0x54,0x63,0x70,0x42,0x72,
-  0x69,0x64,0x67,0x65,0x7C,0x34,0x30,0x30,0x7C,0x36,0x38,0x24,0x4C,0x4D,0x43,0x50,
-  0x00,0x00,0x01,0xCF,0x01,0x43,0x4D,0x41,0x53,0x49,0x00,0x00,0x00,0x00,0x00,0x00,
-  0x0F,0x00,0x03,0x00,0x00,0x00,0x00,0x00,0x00,0x01,0x90,0x41,0xB0,0xD6,0x2D,0x00,
-  0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-  0x00,0x00,0x00,0x43,0x0A,0xF8,0x22,0x00,0x00,0x00,0x00,0x41,0x9F,0xFF,0x72,0x37,
-  0x18,0xF3,0x2C,0x41,0x66,0x0F,0x2B,0x42,0x1E,0x05,0xE2,0x43,0x0A,0xF8,0x22,0x41,
-  0xB0,0xDD,0x90,0x01,0x43,0x4D,0x41,0x53,0x49,0x00,0x00,0x00,0x00,0x00,0x00,0x03,
-  0x00,0x03,0x40,0x46,0xA8,0x88,0xD3,0xEE,0xDB,0xEA,0xC0,0x5E,0x3F,0x6B,0x3D,0xA6,
-  0x0C,0x11,0x44,0x2F,0x00,0x00,0x00,0x00,0x00,0x01,0x42,0xC7,0xFF,0x2F,0x39,0x91,
-  0xC0,0x87,0x00,0x02,0x01,0x43,0x4D,0x41,0x53,0x49,0x00,0x00,0x00,0x00,0x00,0x00,
-  0x1B,0x00,0x03,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x00,0x00,
-  0x01,0x00,0x00,0x00,0x00,0xC2,0x70,0x00,0x00,0x00,0x00,0x00,0x00,0x01,0x43,0x4D,
-  0x41,0x53,0x49,0x00,0x00,0x00,0x00,0x00,0x00,0x15,0x00,0x03,0x00,0x00,0x00,0x00,
-  0x00,0x00,0x27,0x11,0x00,0x00,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x00,0xC2,0x70,
-  0x00,0x00,0x00,0x00,0x00,0x00,0x42,0x34,0x00,0x00,0x42,0x07,0x00,0x00,0x00,0x04,
-  0x01,0x43,0x4D,0x41,0x53,0x49,0x00,0x00,0x00,0x00,0x00,0x00,0x03,0x00,0x03,0x40,
-  0x46,0xA8,0x4A,0xCA,0xB8,0x59,0xE5,0xC0,0x5E,0x3E,0x5C,0x82,0xF5,0xCD,0x81,0x00,
-  0x00,0x00,0x00,0x00,0x00,0x00,0x01,0x01,0x43,0x4D,0x41,0x53,0x49,0x00,0x00,0x00,
-  0x00,0x00,0x00,0x03,0x00,0x03,0x40,0x46,0xA7,0xDE,0xE2,0x2E,0x07,0x46,0xC0,0x5E,
-  0x3F,0x24,0xB4,0xA1,0x86,0xCD,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,0x01,0x43,
-  0x4D,0x41,0x53,0x49,0x00,0x00,0x00,0x00,0x00,0x00,0x03,0x00,0x03,0x40,0x46,0xA8,
-  0x62,0x2A,0x06,0xD4,0x4E,0xC0,0x5E,0x3F,0x5A,0x99,0x2C,0xFD,0x21,0x00,0x00,0x00,
-  0x00,0x00,0x00,0x00,0x01,0x01,0x43,0x4D,0x41,0x53,0x49,0x00,0x00,0x00,0x00,0x00,
-  0x00,0x03,0x00,0x03,0x40,0x46,0xA8,0xD5,0xF9,0x47,0xF4,0xF9,0xC0,0x5E,0x3E,0xEB,
-  0x32,0x6B,0x8C,0x90,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,0x01,0x43,0x4D,0x41,
-  0x53,0x49,0x00,0x00,0x00,0x00,0x00,0x00,0x03,0x00,0x03,0x40,0x46,0xA8,0x5A,0x8D,
-  0xC5,0x49,0xE7,0xC0,0x5E,0x3F,0x07,0xEC,0x63,0x92,0xC8,0x00,0x00,0x00,0x00,0x00,
-  0x00,0x00,0x01,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x03,0x00,0x00,0x00,0x00,0x00,
-  0x00,0x00,0x46,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x16,
-  0x89,0x00,0x00,0x41,0xB0,0xD6,0x2D,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-  0x00,0x00,0x00,0x00,0x00,0x57,0xEC
-#else
-  0x61,0x66,0x72,0x6C,0x2E,0x63,0x6D,0x61,0x73,0x69,0x2E,0x4F,0x70,0x65,0x72,0x61,  /* afrl:cmasi:Opera */
-  0x74,0x69,0x6E,0x67,0x52,0x65,0x67,0x69,0x6F,0x6E,0x24,0x6C,0x6D,0x63,0x70,0x7C,  /* tingRegion$lmcp| */
-  0x61,0x66,0x72,0x6C,0x2E,0x63,0x6D,0x61,0x73,0x69,0x2E,0x4F,0x70,0x65,0x72,0x61,  /* afrl:cmasi:Opera */
-  0x74,0x69,0x6E,0x67,0x52,0x65,0x67,0x69,0x6F,0x6E,0x7C,0x54,0x63,0x70,0x42,0x72,  /* tingRegion|6?p*r */
-  0x69,0x64,0x67,0x65,0x7C,0x34,0x30,0x30,0x7C,0x36,0x38,0x24,0x4C,0x4D,0x43,0x50,  /* idge|400|68$LMCP */
-  0x00,0x00,0x00,0x2B,0x01,0x43,0x4D,0x41,0x53,0x49,0x00,0x00,0x00,0x00,0x00,0x00,  /* ...+.CMASI...... */
-  0x27,0x00,0x03,0x00,0x00,0x00,0x00,0x00,0x00,0x01,0x50,0x00,0x01,0x00,0x00,0x00,  /* '.........P..... */
-  0x00,0x00,0x00,0x01,0x4E,0x00,0x01,0x00,0x00,0x00,0x00,0x00,0x00,0x01,0x4F,0x00,  /* ....N.........O. */
-  0x00,0x03,0xE1                                                                    /* ...              */
-#endif
-};
-
-
 #define DUMP_LINE_LENGTH 32
 #define MAX_DUMP_SIZE (4 * DUMP_LINE_LENGTH)
 
+// Octets handed to the UART per pass of the run loop, one Exynos UART FIFO
+#define TX_BUDGET_PER_POLL 64
 
-int run(void) {
+// Serial messages forwarded per pass of the run loop
+#define SERIAL_RECEIVE_BUDGET 1
+
+
+//------------------------------------------------------------------------------
+// Mission command transmission
+//
+// Mission commands are staged in missionCommandTx and go to the serial link
+// one frame at a time, so a newer command can supersede an unsent one and a
+// return home can overtake a routine window.
+
+static void mission_command_stage(data_t *data, bool priority) {
+  size_t message_size = compute_addr_attr_lmcp_message_size(&data->payload[0], sizeof(data->payload));
+
+  if (message_size > 0) {
+    fprintf(stdout, "apss: received %smission command message of %zu octets\n",
+	    priority ? "priority " : "", message_size);  fflush(stdout);
+    hexdump("    ", DUMP_LINE_LENGTH, &data->payload[0], (message_size > MAX_DUMP_SIZE) ? MAX_DUMP_SIZE : message_size);
+    if (!mission_command_tx_submit(&missionCommandTx, &data->payload[0], message_size, priority)) {
+      fprintf(stdout, "apss: mission command dropped, not a mission command, behind a priority command or no free slot (%" PRIcounter " dropped)\n",
+	      missionCommandTx.dropped);  fflush(stdout);
+    }
+  } else {
+    fprintf(stdout, "apss: received mission command message, decode errno result %d\n", errno);  fflush(stdout);
+    hexdump("    ", DUMP_LINE_LENGTH, &data->payload[0],
+	    (sizeof(data->payload) > MAX_DUMP_SIZE) ? MAX_DUMP_SIZE : sizeof(data->payload));
+  }
+}
 
+static void mission_command_transmit(void) {
+  // Start the next command only once the previous frame is on the wire
+  if (autopilot_serial_server_tx_idle()) {
+    mission_command_tx_slot_t *slot = mission_command_tx_next(&missionCommandTx);
+    if (slot != NULL) {
+      bool written = autopilot_serial_server_write_serial(slot->payload, slot->length) >= 0;
+      if (!written) {
+	fprintf(stdout, "apss: mission command %" PRId64 " could not be queued for transmission\n",
+		slot->command_id);  fflush(stdout);
+      }
+      mission_command_tx_done(&missionCommandTx, slot, written);
+    }
+  }
+  autopilot_serial_server_service_tx(TX_BUDGET_PER_POLL);
+}
+
+
+// Ports are serviced one message at a time, so a handler is done with the
+// message before the next is received into the same buffer
+static data_t portData;
+
+static bool service_mission_command_priority_in(void *context) {
+  (void) context;
   counter_t numDropped;
-  data_t data;
+  if (!mission_command_priority_in_event_data_poll(&numDropped, &portData)) {
+    return false;
+  }
+  mission_command_in_event_data_receive(numDropped, &portData);
+  mission_command_stage(&portData, true);
+  return true;
+}
+
+static bool service_mission_command_in(void *context) {
+  (void) context;
+  counter_t numDropped;
+  if (!mission_command_in_event_data_poll(&numDropped, &portData)) {
+    return false;
+  }
+  mission_command_in_event_data_receive(numDropped, &portData);
+  mission_command_stage(&portData, false);
+  return true;
+}
+
+static bool service_serial_receive(void *context) {
+  (void) context;
+  ssize_t received_size = autopilot_serial_server_read_serial((void *) &portData.payload[0], sizeof(portData.payload));
+
+  if (received_size > 0) {
+    // fprintf(stdout, "apss: received serial message of %zu octets\n", received_size);  fflush(stdout);
+    // hexdump("    ", DUMP_LINE_LENGTH, &portData.payload[0], (received_size> MAX_DUMP_SIZE) ? MAX_DUMP_SIZE : received_size);
+    // TODO: Check that received data is an Air Vehicle State message and discard others
+    air_vehicle_state_forward(&portData, (size_t) received_size);
+    return true;
+  }
+  if (errno != EAGAIN) {
+    fprintf(stdout, "apss: serial receive error %d: %s\n", errno, strerror(errno));
+    fflush(stdout);
+  }
+  return false;
+}
+
+port_executive_t portExecutive;
+
+int run(void) {
+
+  port_executive_init(&portExecutive);
+  port_executive_add(&portExecutive, "mission_command_priority_in", PORT_PRIORITY_SAFETY,
+                     service_mission_command_priority_in, NULL, PORT_EXECUTIVE_DRAIN);
+  port_executive_add(&portExecutive, "mission_command_in", PORT_PRIORITY_COMMAND,
+                     service_mission_command_in, NULL, PORT_EXECUTIVE_DRAIN);
+  port_executive_add(&portExecutive, "serial_receive", PORT_PRIORITY_TELEMETRY,
+                     service_serial_receive, NULL, SERIAL_RECEIVE_BUDGET);
 
   while (1) {
 
     // Busy loop to slow things down
     for (unsigned int j = 0; j < 1000; ++j) {
 
-      // Poll and handle mission command input port
-      bool dataReceived = mission_command_in_event_data_poll(&numDropped, &data);
-
-      if (dataReceived) {
-	
-	mission_command_in_event_data_receive(numDropped, &data);
-
-	size_t message_size = compute_addr_attr_lmcp_message_size(&data.payload[0], sizeof(data.payload));
-
-	if (message_size > 0) {
-	  fprintf(stdout, "apss: received mission command message of %zu octets\n", message_size);  fflush(stdout);
-	  hexdump("    ", DUMP_LINE_LENGTH, &data.payload[0], (message_size > MAX_DUMP_SIZE) ? MAX_DUMP_SIZE : message_size);
-	  autopilot_serial_server_write_serial(&data.payload[0], message_size);
-	} else {
-	  fprintf(stdout, "apss: received mission command message, decode errno result %d\n", errno);  fflush(stdout);
-	  hexdump("    ", DUMP_LINE_LENGTH, &data.payload[0],
-		  (sizeof(data.payload) > MAX_DUMP_SIZE) ? MAX_DUMP_SIZE : sizeof(data.payload));
-	}
-	
-      }
+      // Mission commands are staged before air vehicle state is forwarded,
+      // a return home first
+      port_executive_service(&portExecutive);
 
-      // Poll and handle serial receive
-      ssize_t received_size = autopilot_serial_server_read_serial((void *) &data.payload[0], sizeof(data.payload));
-
-      if (received_size > 0) {
-	// fprintf(stdout, "apss: received serial message of %zu octets\n", received_size);  fflush(stdout);
-	// hexdump("    ", DUMP_LINE_LENGTH, &data.payload[0], (received_size> MAX_DUMP_SIZE) ? MAX_DUMP_SIZE : received_size);    
-	// TODO: Check that received data is an Air Vehicle State message and discard others
-	air_vehicle_state_out_1_event_data_send(&data);
-	air_vehicle_state_out_2_event_data_send(&data);
-      } else {
-	if (errno != EAGAIN) {
-	  fprintf(stdout, "apss: serial receive error %d: %s\n", errno, strerror(errno));
-	  fflush(stdout);
-	}
-      }
+      mission_command_transmit();
 
       seL4_Yield();
 
@@ -262,14 +338,16 @@ int run(void) {
 
     }
 
+    serial_link_stats_update();
+
     // Stage data
-    // memcpy((void *) &data.payload[0], (const void *) &message[0], sizeof(message));
-    // fprintf(stdout, "%s: sending: %d\n", get_instance_name(), sizeof(message));
+    // memcpy((void *) &data.payload[0], (const void *) &air_vehicle_state_sample[0], air_vehicle_state_sample_size);
+    // fprintf(stdout, "%s: sending: %zu\n", get_instance_name(), air_vehicle_state_sample_size);
 
     // Send the data
     // air_vehicle_state_out_1_event_data_send(&data);
     // air_vehicle_state_out_2_event_data_send(&data);
-    // autopilot_serial_server_write_serial(&data.payload[0], sizeof(message));
+    // autopilot_serial_server_write_serial(&data.payload[0], air_vehicle_state_sample_size);
   }
 }
 
@@ -0,0 +1,206 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "lmcp.h"
+#include "AirVehicleState.h"
+#include "KeyValuePair.h"
+#include "Location3D.h"
+#include "PayloadState.h"
+
+#include "avs_forward_policy.h"
+
+
+void avs_forward_policy_init(avs_forward_policy_t *policy, uint32_t decimation, uint64_t min_interval_ns,
+                             bool on_change_waypoint, uint64_t max_interval_ns) {
+  memset(policy, 0, sizeof(*policy));
+  policy->decimation = decimation;
+  policy->min_interval_ns = min_interval_ns;
+  policy->on_change_waypoint = on_change_waypoint;
+  policy->max_interval_ns = max_interval_ns;
+}
+
+
+// The octets of an LMCP object up to the EntityState CurrentWaypoint field, as
+// CMASI packs and unpacks an AirVehicleState
+#define OBJECT_HEADER_SIZE 15         // null flag, series name, type, version
+#define OBJECT_TYPE_OFFSET 9
+#define ENTITY_STATE_FIXED_SIZE 64    // ID, then u through groundspeed
+#define LOCATION3D_SIZE 24
+#define ENERGY_SIZE 8                 // energyAvailable, actualEnergyRate
+
+// Where CurrentWaypoint lies when the Location is present and the
+// PayloadStateList empty, as the autopilot sends it
+#define CURRENT_WAYPOINT_OFFSET (OBJECT_HEADER_SIZE + ENTITY_STATE_FIXED_SIZE + OBJECT_HEADER_SIZE + LOCATION3D_SIZE + ENERGY_SIZE + 2)
+
+
+typedef struct wire {
+  const uint8_t *octets;
+  size_t size;
+  size_t at;
+} wire_t;
+
+
+static bool wire_skip(wire_t *wire, size_t octets) {
+  if (wire->size - wire->at < octets) {
+    return false;
+  }
+  wire->at += octets;
+  return true;
+}
+
+
+static bool wire_uint16(wire_t *wire, uint16_t *value) {
+  if (wire->size - wire->at < 2) {
+    return false;
+  }
+  *value = ((uint16_t) wire->octets[wire->at] << 8) | wire->octets[wire->at + 1];
+  wire->at += 2;
+  return true;
+}
+
+
+static uint32_t wire_type(const uint8_t *header) {
+  const uint8_t *type = &header[OBJECT_TYPE_OFFSET];
+  return (uint32_t) type[0] << 24 | (uint32_t) type[1] << 16 | (uint32_t) type[2] << 8 | type[3];
+}
+
+
+// A nullable object's header, setting *present if its fields follow.  An
+// object of any type but the one named, a subtype for instance, has fields
+// that cannot be skipped here
+static bool wire_object(wire_t *wire, uint32_t type, bool *present) {
+  if (wire->size - wire->at < 1) {
+    return false;
+  }
+  *present = wire->octets[wire->at] != 0;
+  if (!*present) {
+    return wire_skip(wire, 1);
+  }
+  if (wire->size - wire->at < OBJECT_HEADER_SIZE || wire_type(&wire->octets[wire->at]) != type) {
+    return false;
+  }
+  return wire_skip(wire, OBJECT_HEADER_SIZE);
+}
+
+
+// A list length then, if it is a string, that many characters
+static bool wire_string(wire_t *wire) {
+  uint16_t length;
+  return wire_uint16(wire, &length) && wire_skip(wire, length);
+}
+
+
+// The fields of a PayloadState: the PayloadID then the Parameters, each a
+// nullable KeyValuePair of two strings
+static bool wire_payload_state(wire_t *wire) {
+  uint16_t count;
+  if (!wire_skip(wire, 8) || !wire_uint16(wire, &count)) {
+    return false;
+  }
+  for (uint16_t i = 0; i < count; ++i) {
+    bool present;
+    if (!wire_object(wire, LMCP_KeyValuePair_TYPE, &present)) {
+      return false;
+    }
+    if (present && !(wire_string(wire) && wire_string(wire))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+bool avs_forward_policy_current_waypoint(uint8_t *payload, size_t length, int64_t *waypoint) {
+  uint8_t *p = payload;
+  uint8_t *object;
+  size_t object_size;
+
+  if (lmcp_find_msg(&p, length, &object, &object_size) != 0) {
+    return false;
+  }
+  size_t available = payload + length - object;
+  wire_t wire = { object, (object_size < available) ? object_size : available, 0 };
+
+  if (wire.size < OBJECT_HEADER_SIZE || object[0] == 0 || wire_type(object) != LMCP_AirVehicleState_TYPE) {
+    return false;
+  }
+
+  // Only when the Location is missing or the PayloadStateList is not empty
+  // does CurrentWaypoint move, and the fields before it are walked
+  wire.at = CURRENT_WAYPOINT_OFFSET;
+  size_t location = OBJECT_HEADER_SIZE + ENTITY_STATE_FIXED_SIZE;
+  size_t payload_states = CURRENT_WAYPOINT_OFFSET - 2;
+  if (wire.size < CURRENT_WAYPOINT_OFFSET || object[location] == 0
+      || object[payload_states] != 0 || object[payload_states + 1] != 0) {
+    bool present;
+    uint16_t count;
+    wire.at = location;
+    if (!wire_object(&wire, LMCP_Location3D_TYPE, &present) || (present && !wire_skip(&wire, LOCATION3D_SIZE))
+        || !wire_skip(&wire, ENERGY_SIZE) || !wire_uint16(&wire, &count)) {
+      return false;
+    }
+    for (uint16_t i = 0; i < count; ++i) {
+      if (!wire_object(&wire, LMCP_PayloadState_TYPE, &present) || (present && !wire_payload_state(&wire))) {
+        return false;
+      }
+    }
+  }
+
+  if (wire.size - wire.at < 8) {
+    return false;
+  }
+  uint64_t value = 0;
+  for (size_t i = 0; i < 8; ++i) {
+    value = (value << 8) | object[wire.at + i];
+  }
+  *waypoint = (int64_t) value;
+  return true;
+}
+
+
+bool avs_forward_policy_should_forward(avs_forward_policy_t *policy, uint64_t now_ns,
+                                       uint8_t *payload, size_t length) {
+  uint64_t elapsed_ns = now_ns - policy->last_forward_ns;
+
+  // Rate limit
+  if (policy->forwarded_any && policy->min_interval_ns > 0 && elapsed_ns < policy->min_interval_ns) {
+    ++policy->suppressed;
+    return false;
+  }
+
+  // On-change filter, with an optional heartbeat so an idle consumer still
+  // sees the vehicle state now and then
+  int64_t waypoint = 0;
+  bool waypoint_valid = false;
+  if (policy->on_change_waypoint) {
+    waypoint_valid = avs_forward_policy_current_waypoint(payload, length, &waypoint);
+    bool heartbeat_due = policy->max_interval_ns > 0 && elapsed_ns >= policy->max_interval_ns;
+    if (waypoint_valid && policy->forwarded_any && waypoint == policy->last_waypoint && !heartbeat_due) {
+      ++policy->suppressed;
+      return false;
+    }
+  }
+
+  // Decimation
+  if (policy->decimation > 1) {
+    if (policy->decimation_count++ % policy->decimation != 0) {
+      ++policy->suppressed;
+      return false;
+    }
+  }
+
+  if (waypoint_valid) {
+    policy->last_waypoint = waypoint;
+  }
+  policy->forwarded_any = true;
+  policy->last_forward_ns = now_ns;
+  ++policy->forwarded;
+  return true;
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "lmcp.h"
+#include "MissionCommand.h"
+
+#include "mission_command_tx.h"
+
+
+// Address attributed message: attributes '$' address '$' "LMCP" size object checksum
+#define LMCP_CONTROL_STRING_SIZE 4
+#define LMCP_SIZE_SIZE 4
+// Object header: present flag, series name, type, version
+#define LMCP_STRUCT_HEADER_SIZE 15
+#define LMCP_TYPE_OFFSET 9
+
+
+static int64_t read_int64(const uint8_t *p) {
+  uint64_t value = 0;
+  for (int index = 0; index < 8; ++index) {
+    value = (value << 8) | p[index];
+  }
+  return (int64_t) value;
+}
+
+
+bool mission_command_tx_decode_ids(const uint8_t *payload, size_t length, int64_t *command_id, int64_t *vehicle_id) {
+  const uint8_t *end_of_address = memchr(payload, '$', length);
+  if (end_of_address == NULL) {
+    return false;
+  }
+  const uint8_t *end_of_attributes = memchr(end_of_address + 1, '$', length - (end_of_address + 1 - payload));
+  if (end_of_attributes == NULL) {
+    return false;
+  }
+
+  const uint8_t *object = end_of_attributes + 1 + LMCP_CONTROL_STRING_SIZE + LMCP_SIZE_SIZE;
+  if (object + LMCP_STRUCT_HEADER_SIZE + 16 > payload + length || object[0] == 0) {
+    return false;
+  }
+
+  const uint8_t *type = object + LMCP_TYPE_OFFSET;
+  uint32_t object_type = ((uint32_t) type[0] << 24) | ((uint32_t) type[1] << 16)
+    | ((uint32_t) type[2] << 8) | ((uint32_t) type[3] << 0);
+  if (object_type != LMCP_MissionCommand_TYPE) {
+    return false;
+  }
+
+  // VehicleActionCommand fields lead the MissionCommand
+  *command_id = read_int64(object + LMCP_STRUCT_HEADER_SIZE);
+  *vehicle_id = read_int64(object + LMCP_STRUCT_HEADER_SIZE + 8);
+  return true;
+}
+
+
+void mission_command_tx_init(mission_command_tx_t *ctx) {
+  memset(ctx, 0, sizeof(*ctx));
+}
+
+
+bool mission_command_tx_submit(mission_command_tx_t *ctx, const uint8_t *payload, size_t length, bool priority) {
+  int64_t command_id;
+  int64_t vehicle_id;
+
+  if (length > DATA_T_MAX_PAYLOAD || !mission_command_tx_decode_ids(payload, length, &command_id, &vehicle_id)) {
+    ++ctx->dropped;
+    return false;
+  }
+
+  mission_command_tx_slot_t *slot = NULL;
+  mission_command_tx_slot_t *free_slot = NULL;
+  for (size_t index = 0; index < MISSION_COMMAND_TX_SLOTS; ++index) {
+    if (ctx->slot[index].pending && ctx->slot[index].vehicle_id == vehicle_id) {
+      slot = &ctx->slot[index];
+      break;
+    }
+    if (!ctx->slot[index].pending && free_slot == NULL) {
+      free_slot = &ctx->slot[index];
+    }
+  }
+
+  if (slot != NULL && slot->priority && !priority) {
+    // A routine command never replaces a pending return home
+    fprintf(stdout, "apss: mission command %" PRId64 " dropped behind priority command %" PRId64 " for vehicle %" PRId64 "\n",
+            command_id, slot->command_id, vehicle_id);
+    fflush(stdout);
+    ++ctx->dropped;
+    return false;
+  } else if (slot != NULL) {
+    fprintf(stdout, "apss: mission command %" PRId64 " superseded by %" PRId64 " for vehicle %" PRId64 "\n",
+            slot->command_id, command_id, vehicle_id);
+    fflush(stdout);
+    ++ctx->superseded;
+  } else if (free_slot != NULL) {
+    slot = free_slot;
+  } else {
+    ++ctx->dropped;
+    return false;
+  }
+
+  slot->pending = true;
+  slot->priority = priority;
+  slot->vehicle_id = vehicle_id;
+  slot->command_id = command_id;
+  slot->sequence = ctx->next_sequence++;
+  slot->attempts = 0;
+  slot->length = length;
+  memcpy(slot->payload, payload, length);
+  ++ctx->submitted;
+  return true;
+}
+
+
+mission_command_tx_slot_t *mission_command_tx_next(mission_command_tx_t *ctx) {
+  mission_command_tx_slot_t *next = NULL;
+
+  for (size_t index = 0; index < MISSION_COMMAND_TX_SLOTS; ++index) {
+    mission_command_tx_slot_t *slot = &ctx->slot[index];
+    if (slot->pending
+        && (next == NULL
+            || (slot->priority && !next->priority)
+            || (slot->priority == next->priority && slot->sequence < next->sequence))) {
+      next = slot;
+    }
+  }
+
+  return next;
+}
+
+
+void mission_command_tx_done(mission_command_tx_t *ctx, mission_command_tx_slot_t *slot, bool written) {
+  if (written) {
+    slot->pending = false;
+    ++ctx->sent;
+    if (slot->priority) {
+      ++ctx->priority_sent;
+    }
+  } else if (++slot->attempts >= MISSION_COMMAND_TX_ATTEMPTS) {
+    fprintf(stdout, "apss: mission command %" PRId64 " dropped after %" PRIu32 " failed writes\n",
+            slot->command_id, slot->attempts);
+    fflush(stdout);
+    slot->pending = false;
+    ++ctx->dropped;
+  }
+}
@@ -209,6 +209,12 @@ bool sentinel_serial_buffer_append_sentinelized_string(struct sentinel_serial_bu
     __atomic_thread_fence(__ATOMIC_RELEASE);
     *p_write_counter = write_index;
 
+    ctx->stats.octets_in += sentinelized_length;
+    ++ctx->stats.frames_in;
+    if (write_index - read_counter > ctx->stats.high_water) {
+      ctx->stats.high_water = write_index - read_counter;
+    }
+
     // fprintf(stdout, "SSB sending %zu octets (%zu octets sentinelized):\n", length, sentinelized_length);
     // hexdump_ring("    ", DUMP_LINE_LENGTH, &ctx->data[0], SENTINEL_SERIAL_BUFFER_RING_SIZE,
     //              ((size_t) original_write_counter % SENTINEL_SERIAL_BUFFER_RING_SIZE),
@@ -218,6 +224,7 @@ bool sentinel_serial_buffer_append_sentinelized_string(struct sentinel_serial_bu
     return true;
 
   } else {
+    ctx->stats.overflow_drops += sentinelized_length;
     fprintf(stdout, "apss ssb append se str: payload too large: payload %zu, sentinalized %zu, remaining %zu\n",
 	    length, sentinelized_length, capacity_remaining);
     fflush(stdout);
@@ -239,8 +246,13 @@ bool sentinel_serial_buffer_append_char(struct sentinel_serial_buffer *ctx, uint
     // Release memory fence - ensure that data write above completes BEFORE we advance ctx->write_counter
     __atomic_thread_fence(__ATOMIC_RELEASE);
     ++(*p_write_counter);
+    ++ctx->stats.octets_in;
+    if (*p_write_counter - read_counter > ctx->stats.high_water) {
+      ctx->stats.high_water = *p_write_counter - read_counter;
+    }
     return true;
   }
+  ++ctx->stats.overflow_drops;
   return false;
 }
 
@@ -420,6 +432,9 @@ ssize_t sentinel_serial_buffer_get_next_payload_string(struct sentinel_serial_bu
   __atomic_thread_fence(__ATOMIC_RELEASE);
   *p_read_counter = original_read_counter + after_checksum_offset + sizeof(serial_sentinel_after_checksum);
 
+  ctx->stats.octets_out += after_checksum_offset + sizeof(serial_sentinel_after_checksum);
+  ctx->stats.resync_discards += before_payload_size_offset;
+
   size_t payload_size =
     (size_t) sentinel_serial_buffer_ring_strtoul(ctx->data, SENTINEL_SERIAL_BUFFER_RING_SIZE,
 						 original_read_counter
@@ -431,6 +446,7 @@ ssize_t sentinel_serial_buffer_get_next_payload_string(struct sentinel_serial_bu
   fflush(stdout);
   */
   if (errno) {
+    ++ctx->stats.framing_errors;
     errno = EINVAL;
     return -1;
   }
@@ -446,11 +462,13 @@ ssize_t sentinel_serial_buffer_get_next_payload_string(struct sentinel_serial_bu
   fflush(stdout);
   */
   if (errno) {
+    ++ctx->stats.checksum_failures;
     errno = EIO;
     return -1;
   }
 
   if (payload_size > buffer_size) {
+    ++ctx->stats.oversize_frames;
     errno = EFAULT;
     return -1;
   }
@@ -463,10 +481,12 @@ ssize_t sentinel_serial_buffer_get_next_payload_string(struct sentinel_serial_bu
   hexdump("    ", DUMP_LINE_LENGTH, buffer, payload_size);
   */
   if (expected_checksum != computed_checksum) {
+    ++ctx->stats.checksum_failures;
     errno = EIO;
     return -1;
   }
 
+  ++ctx->stats.frames_out;
   errno = 0;
   return payload_size;
 }
@@ -488,6 +508,7 @@ bool sentinel_serial_buffer_get_next_char(struct sentinel_serial_buffer *ctx, ui
     // Release memory fence - ensure copy operation complete BEFORE updating read counter
     __atomic_thread_fence(__ATOMIC_RELEASE);
     *p_read_counter = original_read_counter + 1;
+    ++ctx->stats.octets_out;
 
     return true;
   }
@@ -50,7 +50,7 @@ static getchar_client_t *getchar_client = NULL;
 
 
 /* Forward declarations */
-static void timer_callback(void *data);
+static void serial_service(size_t tx_budget);
 
 
 ssize_t autopilot_serial_server_write_serial(void *data, size_t length)
@@ -58,14 +58,37 @@ ssize_t autopilot_serial_server_write_serial(void *data, size_t length)
     ssize_t result = -1;
     if (sentinel_serial_buffer_append_sentinelized_string(getchar_client->tx_buffer,
 							  (const uint8_t *) data, length)) {
-      /* Kick start the serial by applying the timer_callback */
-      timer_callback(NULL);
+      /* Transmission proceeds as autopilot_serial_server_service_tx is called */
       result = length;
     }
     return result;
 }
 
 
+bool autopilot_serial_server_tx_idle(void)
+{
+    sentinel_serial_buffer_t *tx_buffer = getchar_client->tx_buffer;
+    return tx_buffer->read_counter == tx_buffer->write_counter;
+}
+
+
+void autopilot_serial_server_service_tx(size_t budget)
+{
+    serial_service(budget);
+}
+
+
+void autopilot_serial_server_get_link_counters(serial_link_counters_t *rx, serial_link_counters_t *tx)
+{
+    /* The receive counters are updated from the IRQ handler, take the lock so
+     * the copy is not torn */
+    int UNUSED error = serial_lock(); /* error = sync_mutex_lock(&serial_mutex); */
+    *rx = getchar_client->rx_buffer->stats;
+    *tx = getchar_client->tx_buffer->stats;
+    error = serial_unlock(); /* error = sync_mutex_unlock(&serial_mutex); */
+}
+
+
 ssize_t autopilot_serial_server_read_serial(void *data, size_t length)
 {
   return sentinel_serial_buffer_get_next_payload_string(getchar_client->rx_buffer, (uint8_t *) data, length);
@@ -78,7 +101,7 @@ static void handle_char(uint8_t c)
 }
 
 
-static void timer_callback(void *data)
+static void serial_service(size_t tx_budget)
 {
     int UNUSED error;
     uint8_t c;
@@ -91,8 +114,11 @@ static void timer_callback(void *data)
 	handle_char(buffer[index]);
       }
     }
-    // Flush output
-    while(sentinel_serial_buffer_get_next_char(getchar_client->tx_buffer, &c)) {
+    // Flush output, at most tx_budget octets so that a long frame does not
+    // hold off the receive path or newer mission commands
+    for (size_t sent = 0;
+	 sent < tx_budget && sentinel_serial_buffer_get_next_char(getchar_client->tx_buffer, &c);
+	 ++sent) {
       plat_serial_putchar((int) c);
     }
     error = serial_unlock(); /* error = sync_mutex_unlock(&serial_mutex); */
@@ -106,7 +132,7 @@ int run_serial(void)
     seL4_CPtr notification = timeout_notification();
     while (1) {
         seL4_Wait(notification, NULL);
-        timer_callback(NULL);
+        serial_service(SIZE_MAX);
     }
     return 0;
 }
@@ -13,8 +13,12 @@
 #include <platsupport/irq.h>
 
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <sys/types.h>
 
+#include <serial_link_stats.h>
+
 void serial_pre_init(void);
 
 void serial_post_init(void);
@@ -23,4 +27,10 @@ ssize_t autopilot_serial_server_write_serial(void *data, size_t length);
 
 ssize_t autopilot_serial_server_read_serial(void *data, size_t length);
 
+bool autopilot_serial_server_tx_idle(void);
+
+void autopilot_serial_server_service_tx(size_t budget);
+
+void autopilot_serial_server_get_link_counters(serial_link_counters_t *rx, serial_link_counters_t *tx);
+
 void autopilot_serial_server_irq_handle(void *data, ps_irq_acknowledge_fn_t acknowledge_fn, void *ack_data);
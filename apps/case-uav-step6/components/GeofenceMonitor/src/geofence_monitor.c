@@ -15,6 +15,7 @@
 #include <sys/types.h>
 
 #include "hexdump.h"
+#include "port_executive.h"
 
 #include "lmcp.h"
 #include "common/conv.h"
@@ -145,6 +146,12 @@ bool automation_response_in_event_data_poll(counter_t *numDropped, data_t *data)
     return queue_dequeue(&automationResponseInRecvQueue, numDropped, data);
 }
 
+// As automation_response_in_event_data_poll, copying only the message, at most
+// size octets of it, to buffer, its size being returned in length
+bool automation_response_in_event_message_poll(counter_t *numDropped, uint8_t *buffer, size_t size, size_t *length) {
+    return queue_dequeue_measured(&automationResponseInRecvQueue, numDropped, buffer, size, compute_addr_attr_lmcp_message_size, length);
+}
+
 
 
 void done_emit_underlying(void) WEAK;
@@ -171,18 +178,43 @@ void automation_response_out_event_data_send(data_t *data) {
     done_emit();
 }
 
+// As the event data sends, the payload being the size octets at bytes
 
-void run_poll(void) {
+void alert_out_event_bytes_send(const uint8_t *bytes, size_t size) {
+    queue_enqueue_bytes(alert_out_queue, bytes, size);
+    alert_out_SendEvent_emit();
+    done_emit();
+}
+
+void automation_response_out_event_bytes_send(const uint8_t *bytes, size_t size) {
+    queue_enqueue_bytes(automation_response_out_queue, bytes, size);
+    automation_response_out_SendEvent_emit();
+    done_emit();
+}
+
+
+static data_t portData;
+
+static bool service_automation_response_in(void *context) {
+    (void) context;
     counter_t numDropped;
-    data_t data;
+    if (!automation_response_in_event_data_poll(&numDropped, &portData)) {
+        return false;
+    }
+    automation_response_in_event_data_receive(numDropped, &portData);
+    return true;
+}
 
-    while (true) {
+port_executive_t portExecutive;
 
-        bool dataReceived = automation_response_in_event_data_poll(&numDropped, &data);
-        if (dataReceived) {
-            automation_response_in_event_data_receive(numDropped, &data);
-        }
+void run_poll(void) {
 
+    port_executive_init(&portExecutive);
+    port_executive_add(&portExecutive, "automation_response_in", PORT_PRIORITY_COMMAND,
+                       service_automation_response_in, NULL, PORT_EXECUTIVE_DRAIN);
+
+    while (true) {
+        port_executive_service(&portExecutive);
         seL4_Yield();
     }
 
@@ -11,6 +11,7 @@
 #include <sys/types.h>
 
 #include "hexdump.h"
+#include "lmcp.h"
 
 char geoFenceMsgBuffer[256];
 data_t _geoFenceData;
@@ -46,10 +47,42 @@ void dumpBuffer(size_t numBytes, uint8_t* buffer) {
   fflush(stdout);
 } 
 
-void clearGeoFenceData() {
-  for (int i = 0 ; i < geoFenceDataSizeBytes ; ++i) {
-    geoFenceData->payload[i] = 0;
+// The message got is dequeued straight to output after its event flag, and what
+// earlier gets left after it is zeroed, so CakeML sees what it did when the
+// whole payload was cleared and copied
+size_t payloadSizeBytes(long outputSizeBytes) {
+  if (outputSizeBytes < 1) {
+    return 0;
   }
+  return ((size_t) outputSizeBytes - 1 < geoFenceDataSizeBytes) ? (size_t) outputSizeBytes - 1 : geoFenceDataSizeBytes;
+}
+
+// Zero the octets of the payload after the message got into it that earlier
+// gets left there; *written is how far into the payload they wrote, SIZE_MAX
+// before the first. CakeML reuses the buffer it gets into, so the octets past
+// *written are still zero, and only the tail a longer message left is cleared
+void clearPayloadTail(uint8_t *payload, size_t payloadSize, size_t messageSize, size_t *written) {
+  size_t end = (*written < payloadSize) ? *written : payloadSize;
+  if (messageSize < end) {
+    memset(payload + messageSize, 0, end - messageSize);
+  }
+  *written = messageSize;
+}
+
+// Note a get that failed after writing messageSize octets of the payload
+void notePayloadWritten(size_t messageSize, size_t *written) {
+  if (messageSize > *written) {
+    *written = messageSize;
+  }
+}
+
+// CakeML sends its whole buffer; only the message at the front of it, as
+// measured by compute_addr_attr_lmcp_message_size, is enqueued, the queue
+// zeroing the rest of the payload. If it cannot be measured all size octets
+// are sent, as before
+size_t sentSizeBytes(unsigned char *parameter, size_t size) {
+  size_t messageSize = compute_addr_attr_lmcp_message_size(parameter, size);
+  return (0 < messageSize && messageSize < size) ? messageSize : size;
 }
 
 uint8_t isaacKeepInZone[] = {0x40, 0x46, 0xA6, 0x73, 0x7F, 0x91, 0x58, 0x22, 
@@ -84,17 +117,21 @@ void ffiapi_get_keep_out_zone(unsigned char *parameter, long parameterSizeBytes,
   }
 }
 
-extern bool automation_response_in_event_data_poll(counter_t *numDropped, data_t *data);
+extern bool automation_response_in_event_message_poll(counter_t *, uint8_t *, size_t, size_t *);
 
 void ffiapi_get_observed(unsigned char *parameter, long parameterSizeBytes, unsigned char *output, long outputSizeBytes) {
+  static size_t written = SIZE_MAX;
   counter_t numRcvd = 0;
+  size_t payloadSize = payloadSizeBytes(outputSizeBytes);
+  size_t messageSize = 0;
 
   checkBufferOverrun(outputSizeBytes, geoFenceDataSizeBytes);
-  clearGeoFenceData();
 
-  output[0] = automation_response_in_event_data_poll(&numRcvd, geoFenceData);
+  output[0] = automation_response_in_event_message_poll(&numRcvd, output+1, payloadSize, &messageSize);
   if (output[0]) {
-    memcpy(output+1, geoFenceData->payload, geoFenceDataSizeBytes);
+    clearPayloadTail(output+1, payloadSize, messageSize, &written);
+  } else {
+    notePayloadWritten(messageSize, &written);
   }
   if (numRcvd > 0) {
     sprintf(geoFenceMsgBuffer, "\n\treceived AutomationRequest (%ld)", numRcvd);
@@ -102,21 +139,25 @@ void ffiapi_get_observed(unsigned char *parameter, long parameterSizeBytes, unsi
   }
 }
 
-extern void automation_response_out_event_data_send(data_t *data);
+extern void automation_response_out_event_bytes_send(const uint8_t *bytes, size_t size);
 
 void ffiapi_send_output(unsigned char *parameter, long parameterSizeBytes, unsigned char *output, long outputSizeBytes) {
-  checkBufferOverrun(geoFenceDataSizeBytes, parameterSizeBytes);
-  clearGeoFenceData();
-  memcpy(geoFenceData->payload, parameter, parameterSizeBytes);
-  automation_response_out_event_data_send(geoFenceData);
+  size_t size = parameterSizeBytes;
+
+  checkBufferOverrun(geoFenceDataSizeBytes, size);
+  if (size > geoFenceDataSizeBytes) {
+    size = geoFenceDataSizeBytes;
+  }
+  size = sentSizeBytes(parameter, size);
+  automation_response_out_event_bytes_send(parameter, size);
 }
 
-extern void alert_out_event_data_send(data_t *data);
+extern void alert_out_event_bytes_send(const uint8_t *bytes, size_t size);
 
+// The alert is an empty payload
 void ffiapi_send_alert(unsigned char *parameter, long parameterSizeBytes, unsigned char *output, long outputSizeBytes) {
   checkBufferOverrun(geoFenceDataSizeBytes, parameterSizeBytes);
-  clearGeoFenceData();
-  alert_out_event_data_send(geoFenceData);
+  alert_out_event_bytes_send(NULL, 0);
 }
 
 void ffiapi_float2double(unsigned char *parameter, long parameterSizeBytes, unsigned char *output, long outputSizeBytes)
@@ -15,79 +15,39 @@
 #include <sys/types.h>
 
 #include "hexdump.h"
-
-#include "LineSearchTask.h"
-#include "Location3D.h"
-#include "Wedge.h"
 #include "lmcp.h"
 
-#define LATITUDE_MIN -90.0
-#define LATITUDE_MAX 90.0
-#define LONGITUDE_MIN -180.0
-#define LONGITUDE_MAX 180.0
-#define ALTITUDE_MIN 0.0
-#define ALTITUDE_MAX 5000.0
-#define TASK_ID_MIN 0
-#define TASK_ID_MAX 2000
-#define AZIMUTH_CENTERLINE_MIN -180.0
-#define AZIMUTH_CENTERLINE_MAX 180.0
-#define VERTICAL_CENTERLINE_MIN -180.0
-#define VERTICAL_CENTERLINE_MAX 180.0
+#include "message_schemas.h"
+#include "message_validator.h"
+#include "port_executive.h"
 
 // Forward declarations
 void line_search_task_out_event_data_send(data_t *data);
 
-bool isValidLineSearchTaskMessage(data_t *data) {
+// The line search task schema, compiled
+validator_t lineSearchTaskValidator;
 
-    LineSearchTask *lineSearchTask = NULL;
-    lmcp_init_LineSearchTask(&lineSearchTask);
-
-    if (lineSearchTask != NULL) {
-        uint8_t *payload = &(data->payload[0]);
-        int msg_result = lmcp_process_msg(&payload, sizeof(data->payload), (lmcp_object**)&lineSearchTask);
-
-        if (msg_result == 0) {
-            printf("LineSearchTaskFilter: message received containing %u waypoints\n", lineSearchTask->pointlist_ai.length);
-//            fflush(stdout);
-//            hexdump("    ", 24, data->payload, compute_addr_attr_lmcp_message_size(data->payload, sizeof(data->payload)));
-
-            for (size_t i = 0; i < lineSearchTask->pointlist_ai.length; i++) {
-                Location3D * point = lineSearchTask->pointlist[i];
-                double latitude = unpack754(point->latitude, 64, 11);
-                double longitude = unpack754(point->longitude, 64, 11);
-                float altitude = unpack754(point->altitude, 32, 8);
-                if (latitude < LATITUDE_MIN || latitude > LATITUDE_MAX ||
-                    longitude < LONGITUDE_MIN || longitude > LONGITUDE_MAX ||
-                    altitude < ALTITUDE_MIN || altitude > ALTITUDE_MAX) {
-                        return false;
-                }
-                
-            }
-            
-            if (lineSearchTask->super.super.taskid < TASK_ID_MIN ||
-                lineSearchTask->super.super.taskid > TASK_ID_MAX) {
-                    return false;
-            }
-
-            for (size_t i = 0; i < lineSearchTask->viewanglelist_ai.length; i++) {
-                Wedge * wedge = lineSearchTask->viewanglelist[i];
-                if (unpack754(wedge->azimuthcenterline, 32, 8) < AZIMUTH_CENTERLINE_MIN || unpack754(wedge->azimuthcenterline, 32, 8) > AZIMUTH_CENTERLINE_MAX ||
-                    unpack754(wedge->verticalcenterline, 32, 8) < VERTICAL_CENTERLINE_MIN || unpack754(wedge->verticalcenterline, 32, 8) > VERTICAL_CENTERLINE_MAX) {
-                        return false;
-                }
-            }
+// Is the address attributed message of size octets at message a valid line
+// search task?
+bool isValidLineSearchTaskBytes(const uint8_t *message, size_t size) {
 
-        } else {
+    validator_result_t result;
+    if (!validator_check_message(&lineSearchTaskValidator, message, size, &result)) {
+        if (result.path == NULL) {
             printf("Unable to process LineSearchTask message\n"); fflush(stdout);
-            return false;
+        } else {
+            printf("LineSearchTaskFilter: %s out of bounds, element %u at octet %zu\n", result.path, result.index, result.offset);
+            fflush(stdout);
         }
-    } else {
-        printf("Unable to initialize lineSearchTask\n"); fflush(stdout);
         return false;
     }
     return true;
 }
 
+bool isValidLineSearchTaskMessage(data_t *data) {
+    return isValidLineSearchTaskBytes(data->payload, sizeof(data->payload));
+}
+
 
 //------------------------------------------------------------------------------
 // User specified input data receive handler for AADL Input Event Data Port (in) named
@@ -112,6 +72,24 @@ bool line_search_task_in_event_data_poll(counter_t *numDropped, data_t *data) {
     return queue_dequeue(&lineSearchTaskInRecvQueue, numDropped, data);
 }
 
+// As line_search_task_in_event_data_poll, into the size octets at buffer
+bool line_search_task_in_event_bytes_poll(counter_t *numDropped, uint8_t *buffer, size_t size) {
+    return queue_dequeue_bytes(&lineSearchTaskInRecvQueue, numDropped, buffer, size);
+}
+
+// As line_search_task_in_event_bytes_poll, copying only the message, whose size is
+// returned in length
+bool line_search_task_in_event_message_poll(counter_t *numDropped, uint8_t *buffer, size_t size, size_t *length) {
+    return queue_dequeue_measured(&lineSearchTaskInRecvQueue, numDropped, buffer, size, compute_addr_attr_lmcp_message_size, length);
+}
+
+// As line_search_task_in_event_message_poll, but a message the line search task
+// schema rejects is dropped before the filter sees it
+bool line_search_task_in_event_valid_message_poll(counter_t *numDropped, uint8_t *buffer, size_t size, size_t *length) {
+    return line_search_task_in_event_message_poll(numDropped, buffer, size, length)
+        && isValidLineSearchTaskBytes(buffer, *length);
+}
+
 
 
 void done_emit_underlying(void) WEAK;
@@ -131,18 +109,36 @@ void line_search_task_out_event_data_send(data_t *data) {
     done_emit();
 }
 
+// As line_search_task_out_event_data_send, the payload being the size octets at bytes
+void line_search_task_out_event_bytes_send(const uint8_t *bytes, size_t size) {
+    queue_enqueue_bytes(line_search_task_out_queue, bytes, size);
+    line_search_task_out_SendEvent_emit();
+    done_emit();
+}
+
 
-void run_poll(void) {
+static data_t portData;
+
+static bool service_line_search_task_in(void *context) {
+    (void) context;
     counter_t numDropped;
-    data_t data;
+    if (!line_search_task_in_event_data_poll(&numDropped, &portData)) {
+        return false;
+    }
+    line_search_task_in_event_data_receive(numDropped, &portData);
+    return true;
+}
 
-    while (true) {
+port_executive_t portExecutive;
 
-        bool dataReceived = line_search_task_in_event_data_poll(&numDropped, &data);
-        if (dataReceived) {
-            line_search_task_in_event_data_receive(numDropped, &data);
-        }
+void run_poll(void) {
 
+    port_executive_init(&portExecutive);
+    port_executive_add(&portExecutive, "line_search_task_in", PORT_PRIORITY_COMMAND,
+                       service_line_search_task_in, NULL, PORT_EXECUTIVE_DRAIN);
+
+    while (true) {
+        port_executive_service(&portExecutive);
         seL4_Yield();
     }
 
@@ -151,6 +147,9 @@ void run_poll(void) {
 
 
 void post_init(void) {
+    if (!validator_compile(&lineSearchTaskValidator, line_search_task_schema, line_search_task_schema_size)) {
+        printf("%s: line search task schema is malformed, rejecting all\n", get_instance_name()); fflush(stdout);
+    }
     recv_queue_init(&lineSearchTaskInRecvQueue, line_search_task_in_queue);
     queue_init(line_search_task_out_queue);
 }
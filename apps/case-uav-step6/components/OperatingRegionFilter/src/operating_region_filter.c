@@ -15,10 +15,16 @@
 #include <sys/types.h>
 
 #include "hexdump.h"
+#include "message_schemas.h"
+#include "message_validator.h"
+#include "port_executive.h"
 
 // Forward declarations
 void operating_region_out_event_data_send(data_t *data);
 
+// The operating region schema, compiled
+validator_t operatingRegionValidator;
+
 
 //------------------------------------------------------------------------------
 // User specified input data receive handler for AADL Input Event Data Port (in) named
@@ -26,7 +32,14 @@ void operating_region_out_event_data_send(data_t *data);
 void operating_region_in_event_data_receive(counter_t numDropped, data_t *data) {
     printf("%s: received operating region: numDropped: %" PRIcounter "\n", get_instance_name(), numDropped); fflush(stdout);
     // hexdump("    ", 32, data->payload, sizeof(data->payload));
-    operating_region_out_event_data_send(data);
+
+    validator_result_t result;
+    if (validator_check_message(&operatingRegionValidator, data->payload, sizeof(data->payload), &result)) {
+        operating_region_out_event_data_send(data);
+    } else {
+        printf("%s: operating region is not valid: %s at octet %zu\n", get_instance_name(),
+               (result.path != NULL) ? result.path : "LMCP header", result.offset); fflush(stdout);
+    }
 }
 
 
@@ -58,17 +71,28 @@ void operating_region_out_event_data_send(data_t *data) {
 
 
 
-void run_poll(void) {
+static data_t portData;
+
+static bool service_operating_region_in(void *context) {
+    (void) context;
     counter_t numDropped;
-    data_t data;
+    if (!operating_region_in_event_data_poll(&numDropped, &portData)) {
+        return false;
+    }
+    operating_region_in_event_data_receive(numDropped, &portData);
+    return true;
+}
 
-    while (true) {
+port_executive_t portExecutive;
+
+void run_poll(void) {
 
-        bool dataReceived = operating_region_in_event_data_poll(&numDropped, &data);
-        if (dataReceived) {
-            operating_region_in_event_data_receive(numDropped, &data);
-        }
+    port_executive_init(&portExecutive);
+    port_executive_add(&portExecutive, "operating_region_in", PORT_PRIORITY_COMMAND,
+                       service_operating_region_in, NULL, PORT_EXECUTIVE_DRAIN);
 
+    while (true) {
+        port_executive_service(&portExecutive);
         seL4_Yield();
     }
 
@@ -77,6 +101,9 @@ void run_poll(void) {
 
 
 void post_init(void) {
+    if (!validator_compile(&operatingRegionValidator, operating_region_schema, operating_region_schema_size)) {
+        printf("%s: operating region schema is malformed, rejecting all\n", get_instance_name()); fflush(stdout);
+    }
     recv_queue_init(&operatingRegionInRecvQueue, operating_region_in_queue);
     queue_init(operating_region_out_queue);
 }
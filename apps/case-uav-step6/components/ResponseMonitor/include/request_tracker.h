@@ -0,0 +1,115 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+
+/**
+ * The automation requests waiting on a response from UxAS, their deadlines,
+ * and the latency of those answered.
+ *
+ * Neither the AutomationRequest nor the AutomationResponse carries an ID, so
+ * each request is given the next request ID as it arrives.  UxAS plans the
+ * requests it is sent one after another, so a response answers the oldest
+ * request still outstanding.  A request not answered by its deadline times
+ * out and is forgotten, so a later response is not taken for its answer.
+ *
+ * Requests are kept in a fixed table, REQUEST_TRACKER_CAPACITY of them at a
+ * time, indexed by request ID.  A request that arrives while its entry is
+ * held by one REQUEST_TRACKER_CAPACITY requests older takes the entry, and the
+ * older one is counted as displaced.
+ *
+ * Deadlines are kept in a hashed timer wheel: a request is linked into the
+ * slot for the tick its deadline falls in, modulo the slots.  Expiring visits
+ * only the slots of the ticks that have passed, and the next wake up is found
+ * from the slots ahead, so the component arms a one-shot timeout for the next
+ * deadline rather than counting fixed ticks.
+ *
+ * Latencies are counted in a histogram with four buckets to each doubling of
+ * milliseconds, so percentiles are reported to within a quarter of their
+ * doubling.
+ */
+#define REQUEST_TRACKER_CAPACITY 32
+#define REQUEST_TRACKER_WHEEL_SLOTS 16
+#define REQUEST_TRACKER_LATENCY_BUCKETS 64
+
+#define REQUEST_TRACKER_NONE (-1)
+#define REQUEST_TRACKER_NEVER UINT64_MAX
+
+
+typedef struct request_tracker_entry {
+  bool outstanding;
+  uint32_t request_id;
+  uint64_t received;          // ns
+  uint64_t deadline;          // ns
+  int16_t previous;           // entries in the same wheel slot, or REQUEST_TRACKER_NONE
+  int16_t next;
+} request_tracker_entry_t;
+
+
+typedef struct request_tracker {
+  request_tracker_entry_t entry[REQUEST_TRACKER_CAPACITY];
+  uint32_t next_request_id;
+  uint32_t oldest_request_id;   // no request older than this is outstanding
+
+  // Timer wheel
+  uint64_t tick;                // ns covered by a slot
+  uint64_t current_tick;        // the tick expiry has reached
+  int16_t slot[REQUEST_TRACKER_WHEEL_SLOTS];
+
+  // Latency of the requests answered, ms
+  uint32_t latency[REQUEST_TRACKER_LATENCY_BUCKETS];
+  uint64_t max_latency;
+
+  // Statistics
+  uint32_t requests;
+  uint32_t answered;
+  uint32_t timed_out;
+  uint32_t displaced;
+  uint32_t unmatched;           // responses with no request outstanding
+} request_tracker_t;
+
+
+/**
+ * Each slot of the timer wheel covers tick ns, and expiry starts at now.
+ */
+void request_tracker_init(request_tracker_t *tracker, uint64_t tick, uint64_t now);
+
+
+/**
+ * Track a request received at now, due to be answered within timeout ns.
+ * Returns its request ID.
+ */
+uint32_t request_tracker_request(request_tracker_t *tracker, uint64_t now, uint64_t timeout);
+
+
+/**
+ * Take a response received at now as the answer to the oldest request
+ * outstanding, setting *request_id and *latency, in ns.  Returns false, counting
+ * an unmatched response, if no request is outstanding.
+ */
+bool request_tracker_response(request_tracker_t *tracker, uint64_t now, uint32_t *request_id, uint64_t *latency);
+
+
+/**
+ * Forget a request whose deadline is past at now, setting *request_id.  Returns
+ * false if there is none.  Called until it returns false.
+ */
+bool request_tracker_expire(request_tracker_t *tracker, uint64_t now, uint32_t *request_id);
+
+
+/**
+ * When the component must next wake to expire requests: the earliest deadline
+ * in the slots ahead, or the turn of the wheel if those slots hold only later
+ * deadlines.  REQUEST_TRACKER_NEVER if no request is outstanding.
+ */
+uint64_t request_tracker_next_wakeup(const request_tracker_t *tracker);
+
+
+/**
+ * The latency, in ms, that percent of the requests answered were answered
+ * within, to within the histogram's precision and no more than the greatest.
+ * 0 if none have been answered.
+ */
+uint64_t request_tracker_latency_percentile(const request_tracker_t *tracker, uint32_t percent);
@@ -0,0 +1,209 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "request_tracker.h"
+
+
+#define NS_PER_MS 1000000ULL
+
+// Buckets below this hold one ms each; above it, four to each doubling
+#define EXACT_BUCKETS 4
+
+
+void request_tracker_init(request_tracker_t *tracker, uint64_t tick, uint64_t now) {
+  memset(tracker, 0, sizeof(*tracker));
+  tracker->tick = tick;
+  tracker->current_tick = now / tick;
+  for (int index = 0; index < REQUEST_TRACKER_WHEEL_SLOTS; ++index) {
+    tracker->slot[index] = REQUEST_TRACKER_NONE;
+  }
+}
+
+
+static int16_t *slot_of(request_tracker_t *tracker, uint64_t deadline) {
+  return &tracker->slot[(deadline / tracker->tick) % REQUEST_TRACKER_WHEEL_SLOTS];
+}
+
+
+static void link_entry(request_tracker_t *tracker, int16_t index) {
+  request_tracker_entry_t *entry = &tracker->entry[index];
+  int16_t *head = slot_of(tracker, entry->deadline);
+  entry->previous = REQUEST_TRACKER_NONE;
+  entry->next = *head;
+  if (*head != REQUEST_TRACKER_NONE) {
+    tracker->entry[*head].previous = index;
+  }
+  *head = index;
+}
+
+
+// Remove the entry at index from its wheel slot, and from the outstanding requests
+static void forget(request_tracker_t *tracker, int16_t index) {
+  request_tracker_entry_t *entry = &tracker->entry[index];
+  if (entry->previous != REQUEST_TRACKER_NONE) {
+    tracker->entry[entry->previous].next = entry->next;
+  } else {
+    *slot_of(tracker, entry->deadline) = entry->next;
+  }
+  if (entry->next != REQUEST_TRACKER_NONE) {
+    tracker->entry[entry->next].previous = entry->previous;
+  }
+  entry->outstanding = false;
+}
+
+
+static bool is_outstanding(const request_tracker_t *tracker, uint32_t request_id) {
+  const request_tracker_entry_t *entry = &tracker->entry[request_id % REQUEST_TRACKER_CAPACITY];
+  return entry->outstanding && entry->request_id == request_id;
+}
+
+
+// Move oldest_request_id past the requests no longer outstanding
+static void skip_forgotten(request_tracker_t *tracker) {
+  while (tracker->oldest_request_id != tracker->next_request_id
+         && !is_outstanding(tracker, tracker->oldest_request_id)) {
+    tracker->oldest_request_id++;
+  }
+}
+
+
+uint32_t request_tracker_request(request_tracker_t *tracker, uint64_t now, uint64_t timeout) {
+  uint32_t request_id = tracker->next_request_id++;
+  int16_t index = request_id % REQUEST_TRACKER_CAPACITY;
+  request_tracker_entry_t *entry = &tracker->entry[index];
+
+  if (entry->outstanding) {
+    forget(tracker, index);
+    tracker->displaced++;
+  }
+  entry->outstanding = true;
+  entry->request_id = request_id;
+  entry->received = now;
+  entry->deadline = now + timeout;
+  link_entry(tracker, index);
+  tracker->requests++;
+  skip_forgotten(tracker);
+  return request_id;
+}
+
+
+static uint32_t bucket_of(uint64_t ms) {
+  if (ms < EXACT_BUCKETS) {
+    return ms;
+  }
+  uint32_t doubling = 63 - __builtin_clzll(ms);
+  uint32_t quarter = (ms >> (doubling - 2)) & 3;
+  uint32_t bucket = (doubling - 1) * 4 + quarter;
+  return bucket < REQUEST_TRACKER_LATENCY_BUCKETS ? bucket : REQUEST_TRACKER_LATENCY_BUCKETS - 1;
+}
+
+
+// The greatest latency, ms, in bucket
+static uint64_t bucket_top(uint32_t bucket) {
+  if (bucket < EXACT_BUCKETS) {
+    return bucket;
+  }
+  uint32_t doubling = bucket / 4 + 1;
+  uint32_t quarter = bucket % 4;
+  return ((uint64_t) (4 + quarter + 1) << (doubling - 2)) - 1;
+}
+
+
+bool request_tracker_response(request_tracker_t *tracker, uint64_t now, uint32_t *request_id, uint64_t *latency) {
+  skip_forgotten(tracker);
+  if (tracker->oldest_request_id == tracker->next_request_id) {
+    tracker->unmatched++;
+    return false;
+  }
+
+  int16_t index = tracker->oldest_request_id % REQUEST_TRACKER_CAPACITY;
+  request_tracker_entry_t *entry = &tracker->entry[index];
+  *request_id = entry->request_id;
+  *latency = now - entry->received;
+  forget(tracker, index);
+  skip_forgotten(tracker);
+
+  uint64_t ms = *latency / NS_PER_MS;
+  tracker->latency[bucket_of(ms)]++;
+  if (ms > tracker->max_latency) {
+    tracker->max_latency = ms;
+  }
+  tracker->answered++;
+  return true;
+}
+
+
+bool request_tracker_expire(request_tracker_t *tracker, uint64_t now, uint32_t *request_id) {
+  uint64_t now_tick = now / tracker->tick;
+
+  // The ticks before the last turn of the wheel visit the same slots again
+  if (now_tick > tracker->current_tick + REQUEST_TRACKER_WHEEL_SLOTS) {
+    tracker->current_tick = now_tick - REQUEST_TRACKER_WHEEL_SLOTS;
+  }
+
+  while (true) {
+    int16_t index = tracker->slot[tracker->current_tick % REQUEST_TRACKER_WHEEL_SLOTS];
+    while (index != REQUEST_TRACKER_NONE) {
+      request_tracker_entry_t *entry = &tracker->entry[index];
+      if (entry->deadline <= now) {
+        *request_id = entry->request_id;
+        forget(tracker, index);
+        skip_forgotten(tracker);
+        tracker->timed_out++;
+        return true;
+      }
+      index = entry->next;
+    }
+    if (tracker->current_tick >= now_tick) {
+      return false;
+    }
+    tracker->current_tick++;
+  }
+}
+
+
+uint64_t request_tracker_next_wakeup(const request_tracker_t *tracker) {
+  if (tracker->oldest_request_id == tracker->next_request_id) {
+    return REQUEST_TRACKER_NEVER;
+  }
+
+  for (uint64_t tick = tracker->current_tick; tick < tracker->current_tick + REQUEST_TRACKER_WHEEL_SLOTS; ++tick) {
+    uint64_t earliest = REQUEST_TRACKER_NEVER;
+    int16_t index = tracker->slot[tick % REQUEST_TRACKER_WHEEL_SLOTS];
+    while (index != REQUEST_TRACKER_NONE) {
+      const request_tracker_entry_t *entry = &tracker->entry[index];
+      if (entry->deadline / tracker->tick == tick && entry->deadline < earliest) {
+        earliest = entry->deadline;
+      }
+      index = entry->next;
+    }
+    if (earliest != REQUEST_TRACKER_NEVER) {
+      return earliest;
+    }
+  }
+  return (tracker->current_tick + REQUEST_TRACKER_WHEEL_SLOTS) * tracker->tick;
+}
+
+
+uint64_t request_tracker_latency_percentile(const request_tracker_t *tracker, uint32_t percent) {
+  uint64_t wanted = ((uint64_t) tracker->answered * percent + 99) / 100;
+  uint64_t counted = 0;
+
+  if (tracker->answered == 0) {
+    return 0;
+  }
+  for (uint32_t bucket = 0; bucket < REQUEST_TRACKER_LATENCY_BUCKETS; ++bucket) {
+    counted += tracker->latency[bucket];
+    if (counted >= wanted && counted > 0) {
+      uint64_t top = bucket_top(bucket);
+      return top < tracker->max_latency ? top : tracker->max_latency;
+    }
+  }
+  return tracker->max_latency;
+}
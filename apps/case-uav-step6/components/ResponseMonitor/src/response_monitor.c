@@ -17,8 +17,15 @@
 #include "hexdump.h"
 #include "AutomationResponse.h"
 #include "lmcp.h"
-
-#define TICK_PERIOD (250 * NS_IN_MS)
+#include "port_executive.h"
+#include "request_tracker.h"
+
+// The queues are polled this often, as well as at each deadline
+#define POLL_PERIOD (250 * NS_IN_MS)
+// Time covered by each slot of the timer wheel
+#define WHEEL_TICK (250 * NS_IN_MS)
+// Soonest wakeup armed for a deadline that has already passed
+#define MIN_WAKEUP_DELAY (1 * NS_IN_MS)
 #define AUTOMATION_RESPONSE_TIMEOUT (5000 * NS_IN_MS)
 
 //------------------------------------------------------------------------------
@@ -40,25 +47,70 @@ bool automation_request_in_event_data_poll(counter_t *numDropped, data_t *data)
 
 
 
-//------------------------------------------------------------------------------
-// User specified input data receive handler for AADL Input Event Data Port (in) named
-// "automation_response_in".
-bool automation_response_in_event_data_receive(counter_t numDropped, data_t *data) {
-    printf("%s: received automation response\n", get_instance_name()); fflush(stdout);
-    // hexdump("    ", 32, data->payload, sizeof(data->payload));
+// Address attributed message: attributes '$' address '$' "LMCP" size object checksum
+#define LMCP_CONTROL_STRING_SIZE 4
+#define LMCP_SIZE_SIZE 4
+#define LMCP_CHECKSUM_SIZE 4
+// Object header: present flag, series name, type, version
+#define LMCP_STRUCT_HEADER_SIZE 15
+#define LMCP_TYPE_OFFSET 9
+// MissionCommandList leads the AutomationResponse, its length first
+#define LMCP_ARRAY_LENGTH_SIZE 2
+
+// Octets of an automation response read, enough for its address, attributes
+// and the start of its object
+#define AUTOMATION_RESPONSE_PREFIX_SIZE 512
+
+// Whether the automation response starting with the size octets at prefix has
+// mission commands.  Only the headers and the length of the MissionCommandList
+// are read, so the cost is the same for any response; the geofence monitor
+// checks the whole response.
+static bool hasMissionCommands(const uint8_t *prefix, size_t size) {
+  const uint8_t *end_of_address = memchr(prefix, '$', size);
+  if (end_of_address == NULL) {
+    return false;
+  }
+  const uint8_t *end_of_attributes = memchr(end_of_address + 1, '$', size - (end_of_address + 1 - prefix));
+  if (end_of_attributes == NULL) {
+    return false;
+  }
 
-    AutomationResponse * automationResponse;
-    lmcp_init_AutomationResponse(&automationResponse);
-    
-    uint8_t *payload = &(data->payload[0]);
+  const uint8_t *lmcp = end_of_attributes + 1;
+  const uint8_t *object = lmcp + LMCP_CONTROL_STRING_SIZE + LMCP_SIZE_SIZE;
+  if (object + LMCP_STRUCT_HEADER_SIZE + LMCP_ARRAY_LENGTH_SIZE > prefix + size
+      || memcmp(lmcp, "LMCP", LMCP_CONTROL_STRING_SIZE) != 0 || object[0] == 0) {
+    return false;
+  }
 
-    int msg_result = lmcp_process_msg(&payload, sizeof(data->payload), (lmcp_object**)&automationResponse);
+  // The object must fit in a payload, as lmcp_process_msg would find
+  const uint8_t *object_size = lmcp + LMCP_CONTROL_STRING_SIZE;
+  uint32_t object_octets = ((uint32_t) object_size[0] << 24) | ((uint32_t) object_size[1] << 16)
+    | ((uint32_t) object_size[2] << 8) | ((uint32_t) object_size[3] << 0);
+  if (object_octets > DATA_T_MAX_PAYLOAD - (object - prefix) - LMCP_CHECKSUM_SIZE
+      || object_octets < LMCP_STRUCT_HEADER_SIZE + LMCP_ARRAY_LENGTH_SIZE) {
+    return false;
+  }
 
-    bool result = (msg_result == 0 && automationResponse->missioncommandlist_ai.length > 0);
+  const uint8_t *type = object + LMCP_TYPE_OFFSET;
+  uint32_t object_type = ((uint32_t) type[0] << 24) | ((uint32_t) type[1] << 16)
+    | ((uint32_t) type[2] << 8) | ((uint32_t) type[3] << 0);
+  if (object_type != LMCP_AutomationResponse_TYPE) {
+    return false;
+  }
 
-    lmcp_free_AutomationResponse(automationResponse, 1);
+  const uint8_t *length = object + LMCP_STRUCT_HEADER_SIZE;
+  return (((uint32_t) length[0] << 8) | length[1]) > 0;
+}
 
-    return result;
+//------------------------------------------------------------------------------
+// User specified input data receive handler for AADL Input Event Data Port (in) named
+// "automation_response_in".  Only the first size octets of the response are in
+// prefix.
+bool automation_response_in_event_data_receive(counter_t numDropped, const uint8_t *prefix, size_t size) {
+    printf("%s: received automation response\n", get_instance_name()); fflush(stdout);
+    // hexdump("    ", 32, prefix, size);
+
+    return hasMissionCommands(prefix, size);
 
 }
 
@@ -69,6 +121,11 @@ bool automation_response_in_event_data_poll(counter_t *numDropped, data_t *data)
     return queue_dequeue(&automationResponseInRecvQueue, numDropped, data);
 }
 
+// As automation_response_in_event_data_poll, into the size octets at buffer
+bool automation_response_in_event_bytes_poll(counter_t *numDropped, uint8_t *buffer, size_t size) {
+    return queue_dequeue_bytes(&automationResponseInRecvQueue, numDropped, buffer, size);
+}
+
 
 
 void done_emit_underlying(void) WEAK;
@@ -85,46 +142,125 @@ static void done_emit(void) {
 seL4_CPtr timeout_notification(void);
 
 
-void run_poll(void) {
+// The automation requests outstanding, and the latency of those answered
+request_tracker_t requestTracker;
+
+static void reportLatency(uint32_t requestId, uint64_t latency) {
+    if (latency_report_interval > 0 && requestTracker.answered % latency_report_interval == 0) {
+        printf("%s: request %u answered in %llu ms; latency p50 %llu ms, p99 %llu ms, max %llu ms"
+               " (%u answered, %u timed out, %u displaced, %u unmatched responses)\n",
+               get_instance_name(), requestId, (unsigned long long) (latency / NS_IN_MS),
+               (unsigned long long) request_tracker_latency_percentile(&requestTracker, 50),
+               (unsigned long long) request_tracker_latency_percentile(&requestTracker, 99),
+               (unsigned long long) requestTracker.max_latency,
+               requestTracker.answered, requestTracker.timed_out, requestTracker.displaced,
+               requestTracker.unmatched);
+        fflush(stdout);
+    }
+}
+
+// When the component last woke, the time requests and responses are taken to arrive
+static uint64_t now;
+
+static data_t portData;
+
+static bool service_automation_request_in(void *context) {
+    (void) context;
     counter_t numDropped;
-    data_t data;
+    if (!automation_request_in_event_data_poll(&numDropped, &portData)) {
+        return false;
+    }
+    automation_request_in_event_data_receive(numDropped, &portData);
+    request_tracker_request(&requestTracker, now, AUTOMATION_RESPONSE_TIMEOUT);
+    return true;
+}
+
+static bool service_automation_response_in(void *context) {
+    (void) context;
+    counter_t numDropped;
+    uint8_t responsePrefix[AUTOMATION_RESPONSE_PREFIX_SIZE];
+    uint32_t requestId;
+    uint64_t latency;
+
+    if (!automation_response_in_event_bytes_poll(&numDropped, responsePrefix, sizeof(responsePrefix))) {
+        return false;
+    }
+    if (automation_response_in_event_data_receive(numDropped, responsePrefix, sizeof(responsePrefix))) {
+        if (request_tracker_response(&requestTracker, now, &requestId, &latency)) {
+            reportLatency(requestId, latency);
+        } else {
+            printf("%s: automation response with no request outstanding\n", get_instance_name());
+            fflush(stdout);
+        }
+    }
+    return true;
+}
+
+// Arm the timeout for wakeup.  The absolute one-shot is refused if wakeup
+// has passed, as it may have while the ports were serviced, so a relative
+// one-shot stands behind it, and behind that the periodic poll
+static void armTimeout(uint64_t wakeup) {
+    static bool periodic = false;
+
+    if (timeout_oneshot_absolute(0, wakeup) == 0) {
+        periodic = false;
+        return;
+    }
+    uint64_t current = timeout_time();
+    uint64_t delay = (wakeup > current + MIN_WAKEUP_DELAY) ? wakeup - current : MIN_WAKEUP_DELAY;
+    if (timeout_oneshot_relative(0, delay) == 0) {
+        periodic = false;
+        return;
+    }
+    if (!periodic) {
+        int error = timeout_periodic(0, POLL_PERIOD);
+        printf("%s: could not arm a one-shot timeout, polling every %llu ms%s\n", get_instance_name(),
+               (unsigned long long) (POLL_PERIOD / NS_IN_MS), (error == 0) ? "" : ", nor a periodic one");
+        fflush(stdout);
+        periodic = (error == 0);
+    }
+}
 
-    uint32_t invocations = 0;
+port_executive_t portExecutive;
+
+void run_poll(void) {
+    uint32_t requestId;
 
     seL4_Word badge;
     seL4_CPtr notification = timeout_notification();
-    timeout_periodic(0, TICK_PERIOD);
+    request_tracker_init(&requestTracker, WHEEL_TICK, timeout_time());
 
-    while (true) {
+    // Requests are serviced first, so a response is matched to a request that
+    // arrived in the same wake up
+    port_executive_init(&portExecutive);
+    port_executive_add(&portExecutive, "automation_request_in", PORT_PRIORITY_COMMAND,
+                       service_automation_request_in, NULL, PORT_EXECUTIVE_DRAIN);
+    port_executive_add(&portExecutive, "automation_response_in", PORT_PRIORITY_COMMAND,
+                       service_automation_response_in, NULL, PORT_EXECUTIVE_DRAIN);
 
-        if (invocations > 0) {
-            invocations++;
-        }
+    while (true) {
 
-        bool dataReceived = automation_request_in_event_data_poll(&numDropped, &data);
-        if (dataReceived) {
-            automation_request_in_event_data_receive(numDropped, &data);
-            invocations = 1;
-        }
+        now = timeout_time();
 
-        dataReceived = automation_response_in_event_data_poll(&numDropped, &data);
-        if (dataReceived) {
-            if (automation_response_in_event_data_receive(numDropped, &data)) {
-                invocations = 0;
-            }
-        }
+        port_executive_service(&portExecutive);
 
-        if (invocations > (AUTOMATION_RESPONSE_TIMEOUT / TICK_PERIOD)) {
+        while (request_tracker_expire(&requestTracker, now, &requestId)) {
             printf("\n************************************\n");
             printf("** Response Monitor:              **\n");
             printf("** Expected a response from UxAS, **\n");
             printf("** but did not receive one!       **\n");
             printf("** Consider aborting mission.     **\n");
             printf("************************************\n\n");
+            printf("%s: request %u timed out\n", get_instance_name(), requestId);
             fflush(stdout);
-            invocations = 0;
         }
 
+        uint64_t wakeup = request_tracker_next_wakeup(&requestTracker);
+        if (wakeup > now + POLL_PERIOD) {
+            wakeup = now + POLL_PERIOD;
+        }
+        armTimeout(wakeup);
+
         seL4_Wait(notification, &badge);
     }
 
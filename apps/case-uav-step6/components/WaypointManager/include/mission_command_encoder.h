@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "Waypoint.h"
+
+
+// Room for the attributes and the MissionCommand fields ahead of the waypoints
+#define MISSION_COMMAND_ENCODER_PREFIX_MAX 256
+
+
+/**
+ * Encoder for address attributed MissionCommand messages built from waypoints
+ * that were encoded ahead of time.
+ *
+ * The wire format of a MissionCommand is the attributes, "LMCP", the object
+ * size, the object header, the commandid, vehicleid, an empty vehicle action
+ * list and status, the waypoint count, the waypoints, the firstwaypoint and a
+ * checksum over everything after the attributes.  Only the size, commandid,
+ * count, firstwaypoint and checksum differ from one window to the next, so the
+ * encoder keeps the rest as a template produced once by the LMCP packer, and
+ * the checksum, a plain byte sum, is assembled from sums kept with the
+ * template and with each waypoint.
+ */
+typedef struct mission_command_encoder {
+  uint8_t prefix[MISSION_COMMAND_ENCODER_PREFIX_MAX];
+  size_t prefix_length;       // attributes up to and including the waypoint count
+  size_t checksum_start;      // length of the attributes
+  size_t size_offset;
+  size_t command_id_offset;
+  size_t count_offset;
+  uint32_t object_size;       // LMCP object size with no waypoints
+  uint32_t prefix_sum;        // byte sum of the checksummed prefix, patched fields zeroed
+} mission_command_encoder_t;
+
+
+/**
+ * Waypoints encoded as they appear in a MissionCommand waypoint list, object
+ * header included, indexed by their position in the list they were loaded
+ * from.
+ */
+typedef struct mission_command_waypoints {
+  uint8_t *blobs;
+  size_t *offset;
+  uint32_t *length;
+  uint32_t *sum;
+  uint32_t count;
+} mission_command_waypoints_t;
+
+
+/**
+ * Build the template for MissionCommands carrying attributes, vehicle_id and
+ * status.  Returns false if the prefix does not fit.
+ */
+bool mission_command_encoder_init(mission_command_encoder_t *encoder, const char *attributes, int64_t vehicle_id,
+                                  int32_t status);
+
+
+void mission_command_waypoints_init(mission_command_waypoints_t *waypoints);
+
+
+/**
+ * Encode length waypoints.  Returns false, leaving the set empty, if the
+ * buffers cannot be allocated.
+ */
+bool mission_command_waypoints_load(mission_command_waypoints_t *waypoints, Waypoint **list, uint32_t length);
+
+
+void mission_command_waypoints_clear(mission_command_waypoints_t *waypoints);
+
+
+/**
+ * Assemble a MissionCommand into buffer from the waypoints at the count
+ * positions given.  Returns the message length, or 0 if it does not fit in
+ * size octets.
+ */
+size_t mission_command_encoder_encode(const mission_command_encoder_t *encoder,
+                                      const mission_command_waypoints_t *waypoints,
+                                      const uint32_t *positions, uint32_t count,
+                                      int64_t command_id, int64_t first_waypoint,
+                                      uint8_t *buffer, size_t size);
+
+
+/**
+ * Replace the commandid of a message of length octets previously produced by
+ * mission_command_encoder_encode, updating the checksum to match.
+ */
+void mission_command_encoder_set_command_id(const mission_command_encoder_t *encoder, uint8_t *buffer, size_t length,
+                                            int64_t command_id);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+#include <sys/types.h>
+
+
+// Vehicles one WaypointManager serves, and the hash slots that find them
+#define VEHICLE_TABLE_CAPACITY 8
+#define VEHICLE_TABLE_SLOTS (2 * VEHICLE_TABLE_CAPACITY)
+
+#define VEHICLE_TABLE_NONE UINT32_MAX
+
+
+/**
+ * Fixed capacity map from vehicle id to an entry number in
+ * [0, VEHICLE_TABLE_CAPACITY), for the caller to index its own per vehicle
+ * state with.  Entries are handed out in order of first insertion and never
+ * removed, and the hash table is kept at most half full, so a lookup is a
+ * short probe whatever the number of vehicles.
+ */
+typedef struct vehicle_table {
+  int64_t id[VEHICLE_TABLE_CAPACITY];
+  uint32_t count;
+  uint8_t slot[VEHICLE_TABLE_SLOTS];    // entry number + 1, 0 for an empty slot
+} vehicle_table_t;
+
+
+void vehicle_table_init(vehicle_table_t *table);
+
+
+/**
+ * Entry of the vehicle with id, or VEHICLE_TABLE_NONE.
+ */
+uint32_t vehicle_table_find(const vehicle_table_t *table, int64_t id);
+
+
+/**
+ * Entry of the vehicle with id, adding it if it is not already in the table.
+ * Returns VEHICLE_TABLE_NONE if the table is full.
+ */
+uint32_t vehicle_table_insert(vehicle_table_t *table, int64_t id);
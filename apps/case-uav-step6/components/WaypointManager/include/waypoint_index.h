@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "Waypoint.h"
+
+
+#define WAYPOINT_INDEX_NONE UINT32_MAX
+
+
+/**
+ * Index over the waypoint list of a MissionCommand, built once when an
+ * AutomationResponse arrives so that the per AirVehicleState work is
+ * proportional to the window size rather than the mission size.
+ *
+ *     hash            open addressed map from waypoint number to position in
+ *                     the waypoint list.  As with a linear search, the first
+ *                     of several waypoints with the same number wins.
+ *     next            position of each waypoint's nextwaypoint, or
+ *                     WAYPOINT_INDEX_NONE if it does not resolve
+ *     chain           the positions visited following nextwaypoint from the
+ *                     mission's first waypoint.  When the route closes a cycle
+ *                     the walk continues for unroll - 1 more waypoints, so a
+ *                     window of up to unroll waypoints starting anywhere on the
+ *                     route is a contiguous slice of the chain.
+ *     chain_offset    offset of each position's first visit in chain, or
+ *                     WAYPOINT_INDEX_NONE if the route never visits it
+ *
+ * The Waypoint pointers are borrowed from the waypoint list, which must outlive
+ * the index.
+ */
+typedef struct waypoint_index {
+  Waypoint **waypoints;
+  uint32_t length;
+
+  uint32_t hash_mask;
+  uint32_t *hash;
+
+  uint32_t *next;
+
+  uint32_t *chain;
+  uint32_t chain_length;
+  uint32_t *chain_offset;
+} waypoint_index_t;
+
+
+void waypoint_index_init(waypoint_index_t *index);
+
+
+/**
+ * Build the index for waypoints, following the route from the waypoint
+ * numbered first.  Returns false, leaving the index empty, if the tables cannot
+ * be allocated.
+ */
+bool waypoint_index_build(waypoint_index_t *index, Waypoint **waypoints, uint32_t length, int64_t first,
+                          uint32_t unroll);
+
+
+/**
+ * Release the tables.  The index is left empty and may be built again.
+ */
+void waypoint_index_clear(waypoint_index_t *index);
+
+
+/**
+ * Position of the waypoint numbered number, or WAYPOINT_INDEX_NONE.
+ */
+uint32_t waypoint_index_find(const waypoint_index_t *index, int64_t number);
+
+
+/**
+ * Write to route the positions of the count waypoints on the route starting at
+ * the waypoint numbered start, unrolling cycles.  Returns the number of
+ * positions written, which is less than count if the route reaches a
+ * nextwaypoint that does not resolve (or start itself does not).
+ */
+uint32_t waypoint_index_route(const waypoint_index_t *index, int64_t start, uint32_t *route, uint32_t count);
@@ -0,0 +1,191 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "lmcp.h"
+#include "common/conv.h"
+#include "MissionCommand.h"
+#include "Waypoint.h"
+#include "AddressAttributedMessage.h"
+
+#include "mission_command_encoder.h"
+
+
+// Object header ahead of each LMCP object: present flag, series name, type
+// and version
+#define OBJECT_HEADER_SIZE 15
+
+// "LMCP" and the object size
+#define MESSAGE_HEADER_SIZE 8
+
+#define FIRST_WAYPOINT_SIZE sizeof(int64_t)
+#define CHECKSUM_SIZE sizeof(uint32_t)
+
+
+static uint32_t byte_sum(const uint8_t *buffer, size_t length) {
+  uint32_t sum = 0;
+  for (size_t i = 0; i < length; ++i) {
+    sum += buffer[i];
+  }
+  return sum;
+}
+
+
+static uint32_t read_uint32(const uint8_t *buffer) {
+  return ((uint32_t) buffer[0] << 24) | ((uint32_t) buffer[1] << 16) | ((uint32_t) buffer[2] << 8) | buffer[3];
+}
+
+
+bool mission_command_encoder_init(mission_command_encoder_t *encoder, const char *attributes, int64_t vehicle_id,
+                                  int32_t status) {
+  bool result = false;
+  MissionCommand *missionCommand = NULL;
+  AddressAttributedMessage *addressAttributedMessage = NULL;
+
+  memset(encoder, 0, sizeof(*encoder));
+
+  // Let the LMCP packer lay out a MissionCommand with no waypoints
+  lmcp_init_MissionCommand(&missionCommand);
+  lmcp_init_AddressAttributedMessage(&addressAttributedMessage);
+  if (missionCommand != NULL && addressAttributedMessage != NULL) {
+    missionCommand->super.vehicleid = vehicle_id;
+    missionCommand->super.status = status;
+    missionCommand->waypointlist_ai.length = 0;
+    addressAttributedMessage->attributes = (char *) attributes;
+    addressAttributedMessage->lmcp_obj = (lmcp_object *) missionCommand;
+
+    uint8_t message[MISSION_COMMAND_ENCODER_PREFIX_MAX + FIRST_WAYPOINT_SIZE + CHECKSUM_SIZE];
+    if (lmcp_packsize_AddressAttributedMessage(addressAttributedMessage) <= sizeof(message)) {
+      size_t length = lmcp_pack_AddressAttributedMessage(message, addressAttributedMessage);
+
+      encoder->checksum_start = strlen(attributes);
+      encoder->size_offset = encoder->checksum_start + 4;
+      encoder->command_id_offset = encoder->checksum_start + MESSAGE_HEADER_SIZE + OBJECT_HEADER_SIZE;
+      encoder->prefix_length = length - FIRST_WAYPOINT_SIZE - CHECKSUM_SIZE;
+      encoder->count_offset = encoder->prefix_length - sizeof(uint16_t);
+      encoder->object_size = read_uint32(&message[encoder->size_offset]);
+
+      memcpy(encoder->prefix, message, encoder->prefix_length);
+      memset(&encoder->prefix[encoder->size_offset], 0, sizeof(uint32_t));
+      memset(&encoder->prefix[encoder->command_id_offset], 0, sizeof(int64_t));
+      memset(&encoder->prefix[encoder->count_offset], 0, sizeof(uint16_t));
+      encoder->prefix_sum = byte_sum(&encoder->prefix[encoder->checksum_start],
+                                     encoder->prefix_length - encoder->checksum_start);
+      result = true;
+    }
+  }
+
+  if (missionCommand != NULL) {
+    lmcp_free_MissionCommand(missionCommand, 1);
+  }
+  lmcp_free_AddressAttributedMessage(addressAttributedMessage, 1);
+
+  return result;
+}
+
+
+void mission_command_waypoints_init(mission_command_waypoints_t *waypoints) {
+  memset(waypoints, 0, sizeof(*waypoints));
+}
+
+
+void mission_command_waypoints_clear(mission_command_waypoints_t *waypoints) {
+  free(waypoints->blobs);
+  free(waypoints->offset);
+  free(waypoints->length);
+  free(waypoints->sum);
+  mission_command_waypoints_init(waypoints);
+}
+
+
+bool mission_command_waypoints_load(mission_command_waypoints_t *waypoints, Waypoint **list, uint32_t length) {
+  mission_command_waypoints_clear(waypoints);
+
+  size_t total = 0;
+  for (uint32_t i = 0; i < length; ++i) {
+    total += OBJECT_HEADER_SIZE + lmcp_packsize_Waypoint(list[i]);
+  }
+
+  waypoints->blobs = malloc(total > 0 ? total : 1);
+  waypoints->offset = malloc(sizeof(size_t) * (length > 0 ? length : 1));
+  waypoints->length = malloc(sizeof(uint32_t) * (length > 0 ? length : 1));
+  waypoints->sum = malloc(sizeof(uint32_t) * (length > 0 ? length : 1));
+  if (waypoints->blobs == NULL || waypoints->offset == NULL || waypoints->length == NULL || waypoints->sum == NULL) {
+    mission_command_waypoints_clear(waypoints);
+    return false;
+  }
+
+  size_t offset = 0;
+  for (uint32_t i = 0; i < length; ++i) {
+    uint8_t *blob = &waypoints->blobs[offset];
+    size_t blob_length = lmcp_pack_Waypoint_header(blob, list[i]);
+    blob_length += lmcp_pack_Waypoint(blob + blob_length, list[i]);
+    waypoints->offset[i] = offset;
+    waypoints->length[i] = (uint32_t) blob_length;
+    waypoints->sum[i] = byte_sum(blob, blob_length);
+    offset += blob_length;
+  }
+  waypoints->count = length;
+
+  return true;
+}
+
+
+size_t mission_command_encoder_encode(const mission_command_encoder_t *encoder,
+                                      const mission_command_waypoints_t *waypoints,
+                                      const uint32_t *positions, uint32_t count,
+                                      int64_t command_id, int64_t first_waypoint,
+                                      uint8_t *buffer, size_t size) {
+  if (count > UINT16_MAX) {
+    return 0;
+  }
+
+  size_t length = encoder->prefix_length;
+  uint32_t waypoints_size = 0;
+  uint32_t checksum = encoder->prefix_sum;
+  for (uint32_t i = 0; i < count; ++i) {
+    if (positions[i] >= waypoints->count) {
+      return 0;
+    }
+    waypoints_size += waypoints->length[positions[i]];
+    checksum += waypoints->sum[positions[i]];
+  }
+  if (length + waypoints_size + FIRST_WAYPOINT_SIZE + CHECKSUM_SIZE > size) {
+    return 0;
+  }
+
+  memcpy(buffer, encoder->prefix, encoder->prefix_length);
+  lmcp_pack_uint32_t(&buffer[encoder->size_offset], encoder->object_size + waypoints_size);
+  lmcp_pack_int64_t(&buffer[encoder->command_id_offset], command_id);
+  lmcp_pack_uint16_t(&buffer[encoder->count_offset], (uint16_t) count);
+  checksum += byte_sum(&buffer[encoder->size_offset], sizeof(uint32_t));
+  checksum += byte_sum(&buffer[encoder->command_id_offset], sizeof(int64_t));
+  checksum += byte_sum(&buffer[encoder->count_offset], sizeof(uint16_t));
+
+  for (uint32_t i = 0; i < count; ++i) {
+    memcpy(&buffer[length], &waypoints->blobs[waypoints->offset[positions[i]]], waypoints->length[positions[i]]);
+    length += waypoints->length[positions[i]];
+  }
+
+  length += lmcp_pack_int64_t(&buffer[length], first_waypoint);
+  checksum += byte_sum(&buffer[length - FIRST_WAYPOINT_SIZE], FIRST_WAYPOINT_SIZE);
+
+  length += lmcp_pack_uint32_t(&buffer[length], checksum);
+  return length;
+}
+
+
+void mission_command_encoder_set_command_id(const mission_command_encoder_t *encoder, uint8_t *buffer, size_t length,
+                                            int64_t command_id) {
+  uint8_t *field = &buffer[encoder->command_id_offset];
+  uint32_t checksum = read_uint32(&buffer[length - CHECKSUM_SIZE]) - byte_sum(field, sizeof(int64_t));
+  lmcp_pack_int64_t(field, command_id);
+  checksum += byte_sum(field, sizeof(int64_t));
+  lmcp_pack_uint32_t(&buffer[length - CHECKSUM_SIZE], checksum);
+}
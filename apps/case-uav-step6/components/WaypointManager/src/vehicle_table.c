@@ -0,0 +1,57 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "vehicle_table.h"
+
+
+// Fibonacci hashing multiplier, 2^64 / golden ratio
+#define HASH_MULTIPLIER 0x9E3779B97F4A7C15ULL
+
+_Static_assert((VEHICLE_TABLE_SLOTS & (VEHICLE_TABLE_SLOTS - 1)) == 0, "slot count must be a power of two");
+_Static_assert(VEHICLE_TABLE_CAPACITY < UINT8_MAX, "entry numbers must fit a slot");
+
+
+static inline uint32_t hash_slot(int64_t id) {
+  return (uint32_t) (((uint64_t) id * HASH_MULTIPLIER) >> 32) & (VEHICLE_TABLE_SLOTS - 1);
+}
+
+
+// Slot holding id, or the empty slot where it would go
+static uint32_t probe(const vehicle_table_t *table, int64_t id) {
+  uint32_t slot = hash_slot(id);
+  while (table->slot[slot] != 0 && table->id[table->slot[slot] - 1] != id) {
+    slot = (slot + 1) & (VEHICLE_TABLE_SLOTS - 1);
+  }
+  return slot;
+}
+
+
+void vehicle_table_init(vehicle_table_t *table) {
+  memset(table, 0, sizeof(*table));
+}
+
+
+uint32_t vehicle_table_find(const vehicle_table_t *table, int64_t id) {
+  uint32_t slot = probe(table, id);
+  return (table->slot[slot] != 0) ? table->slot[slot] - 1u : VEHICLE_TABLE_NONE;
+}
+
+
+uint32_t vehicle_table_insert(vehicle_table_t *table, int64_t id) {
+  uint32_t slot = probe(table, id);
+  if (table->slot[slot] != 0) {
+    return table->slot[slot] - 1u;
+  }
+  if (table->count == VEHICLE_TABLE_CAPACITY) {
+    return VEHICLE_TABLE_NONE;
+  }
+  uint32_t entry = table->count++;
+  table->id[entry] = id;
+  table->slot[slot] = (uint8_t) (entry + 1);
+  return entry;
+}
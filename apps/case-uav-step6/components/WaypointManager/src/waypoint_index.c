@@ -0,0 +1,139 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "Waypoint.h"
+
+#include "waypoint_index.h"
+
+
+// Smallest hash table, and the largest waypoint list the index will take on
+#define MIN_HASH_SIZE 16
+#define MAX_LENGTH (UINT32_MAX >> 2)
+
+// Fibonacci hashing multiplier, 2^64 / golden ratio
+#define HASH_MULTIPLIER 0x9E3779B97F4A7C15ULL
+
+
+static inline uint32_t hash_slot(const waypoint_index_t *index, int64_t number) {
+  return (uint32_t) (((uint64_t) number * HASH_MULTIPLIER) >> 32) & index->hash_mask;
+}
+
+
+void waypoint_index_init(waypoint_index_t *index) {
+  memset(index, 0, sizeof(*index));
+}
+
+
+void waypoint_index_clear(waypoint_index_t *index) {
+  free(index->hash);
+  free(index->next);
+  free(index->chain);
+  free(index->chain_offset);
+  waypoint_index_init(index);
+}
+
+
+uint32_t waypoint_index_find(const waypoint_index_t *index, int64_t number) {
+  if (index->hash == NULL) {
+    return WAYPOINT_INDEX_NONE;
+  }
+  for (uint32_t slot = hash_slot(index, number); index->hash[slot] != WAYPOINT_INDEX_NONE;
+       slot = (slot + 1) & index->hash_mask) {
+    if (index->waypoints[index->hash[slot]]->number == number) {
+      return index->hash[slot];
+    }
+  }
+  return WAYPOINT_INDEX_NONE;
+}
+
+
+bool waypoint_index_build(waypoint_index_t *index, Waypoint **waypoints, uint32_t length, int64_t first,
+                          uint32_t unroll) {
+  waypoint_index_clear(index);
+
+  if (length > MAX_LENGTH) {
+    return false;
+  }
+
+  uint32_t hash_size = MIN_HASH_SIZE;
+  while (hash_size < 2 * length) {
+    hash_size *= 2;
+  }
+  uint32_t chain_capacity = length + (unroll > 0 ? unroll - 1 : 0);
+
+  index->hash = malloc(sizeof(uint32_t) * hash_size);
+  index->next = malloc(sizeof(uint32_t) * (length > 0 ? length : 1));
+  index->chain = malloc(sizeof(uint32_t) * (chain_capacity > 0 ? chain_capacity : 1));
+  index->chain_offset = malloc(sizeof(uint32_t) * (length > 0 ? length : 1));
+  if (index->hash == NULL || index->next == NULL || index->chain == NULL || index->chain_offset == NULL) {
+    waypoint_index_clear(index);
+    return false;
+  }
+
+  index->waypoints = waypoints;
+  index->length = length;
+  index->hash_mask = hash_size - 1;
+  memset(index->hash, 0xff, sizeof(uint32_t) * hash_size);
+
+  // Number to position, keeping the first of any duplicates
+  for (uint32_t position = 0; position < length; ++position) {
+    uint32_t slot = hash_slot(index, waypoints[position]->number);
+    while (index->hash[slot] != WAYPOINT_INDEX_NONE
+           && waypoints[index->hash[slot]]->number != waypoints[position]->number) {
+      slot = (slot + 1) & index->hash_mask;
+    }
+    if (index->hash[slot] == WAYPOINT_INDEX_NONE) {
+      index->hash[slot] = position;
+    }
+  }
+
+  // Successors
+  for (uint32_t position = 0; position < length; ++position) {
+    index->next[position] = waypoint_index_find(index, waypoints[position]->nextwaypoint);
+    index->chain_offset[position] = WAYPOINT_INDEX_NONE;
+  }
+
+  // Flatten the route from the first waypoint, unrolling a closing cycle
+  uint32_t position = waypoint_index_find(index, first);
+  while (position != WAYPOINT_INDEX_NONE && index->chain_offset[position] == WAYPOINT_INDEX_NONE) {
+    index->chain_offset[position] = index->chain_length;
+    index->chain[index->chain_length++] = position;
+    position = index->next[position];
+  }
+  for (uint32_t count = 1; position != WAYPOINT_INDEX_NONE && count < unroll; ++count) {
+    index->chain[index->chain_length++] = position;
+    position = index->next[position];
+  }
+
+  return true;
+}
+
+
+// A slice of the chain where the route has been flattened, then successors one
+// at a time for anything beyond it
+uint32_t waypoint_index_route(const waypoint_index_t *index, int64_t start, uint32_t *route, uint32_t count) {
+  uint32_t filled = 0;
+  uint32_t position = waypoint_index_find(index, start);
+
+  if (position != WAYPOINT_INDEX_NONE && index->chain_offset[position] != WAYPOINT_INDEX_NONE) {
+    uint32_t offset = index->chain_offset[position];
+    uint32_t available = index->chain_length - offset;
+    filled = (available < count) ? available : count;
+    memcpy(route, &index->chain[offset], sizeof(uint32_t) * filled);
+    position = (filled < count) ? index->next[route[filled - 1]] : WAYPOINT_INDEX_NONE;
+  }
+
+  while (filled < count && position != WAYPOINT_INDEX_NONE) {
+    route[filled++] = position;
+    position = index->next[position];
+  }
+
+  return filled;
+}
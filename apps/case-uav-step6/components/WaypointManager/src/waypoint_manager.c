@@ -25,7 +25,12 @@
 #include "AutomationResponse.h"
 #include "AddressAttributedMessage.h"
 
-#define VEHICLE_ID 400
+#include "waypoint_index.h"
+#include "mission_command_encoder.h"
+#include "vehicle_table.h"
+#include "generic_timer.h"
+#include "port_executive.h"
+
 #define WINDOW_SIZE 15
 #define WINDOW_OVERLAP 5
 #define INIT_CMD_ID 101
@@ -35,23 +40,82 @@
 #define HOME_WAYPOINT_SPEED 1102053376U
 #define HOME_WAYPOINT_NUM 17554
 
-int64_t currentWaypoint;
-int64_t currentCommand;
+// window_prestage_policy values
+#define WINDOW_PRESTAGE_OFF 0
+#define WINDOW_PRESTAGE_COMMIT 1
+#define WINDOW_PRESTAGE_EARLY 2
+
+// Air vehicle states decoded between yields; a return home is serviced between each
+#define AIR_VEHICLE_STATE_IN_BUDGET 1
+
+#define MISSION_COMMAND_ATTRIBUTES_FORMAT "afrl.cmasi.MissionCommand$lmcp|afrl.cmasi.MissionCommand||%lld|63$"
+#define MISSION_COMMAND_ATTRIBUTES_MAX 96
+
+// Everything the WaypointManager tracks for one vehicle
+typedef struct vehicle {
+  int64_t id;
+
+  // The vehicle's MissionCommand, taken from the AutomationResponse it came
+  // in, with the index over its waypoints and the waypoints pre-encoded,
+  // all rebuilt when it changes
+  MissionCommand *mission;
+  waypoint_index_t waypointIndex;
+  mission_command_waypoints_t missionWaypoints;
+
+  // Window cursor and command counter
+  int64_t currentWaypoint;
+  int64_t currentCommand;
+
+  // MissionCommand template, and the complete return home command
+  mission_command_encoder_t missionCommandEncoder;
+  data_t returnHomeMessage;
+  size_t returnHomeMessageLength;
+
+  // Next window, encoded ahead of the transition by the commit pre-staging
+  // policy.  stagedWindowStart is the waypoint it starts at, valid while the
+  // window starting at stagedWindowFrom is current.
+  data_t stagedWindow;
+  size_t stagedWindowLength;
+  int64_t stagedWindowStart;
+  int64_t stagedWindowFrom;
+} vehicle_t;
+
+vehicle_table_t vehicleTable;
+vehicle_t vehicles[VEHICLE_TABLE_CAPACITY];
+uint32_t missionCount;        // vehicles with a mission
+
 bool returnHome;
-AutomationResponse * automationResponse;
 Waypoint * homeWaypoint;
+mission_command_waypoints_t homeWaypoints;
+
+// Window transition latency, from taking the AirVehicleState that moves the
+// window to queuing its MissionCommand, in generic timer ticks
+typedef struct window_transition_stats {
+  uint32_t count;
+  uint32_t staged;            // committed from a pre-staged window
+  uint32_t early;             // sent early by the early policy
+  uint64_t total;
+  uint64_t max;
+  uint64_t last;
+} window_transition_stats_t;
+
+window_transition_stats_t windowTransitionStats;
+uint32_t timerFrequency;
 
 
 // Forward declarations
 void mission_command_out_event_data_send(data_t *data);
-void sendMissionCommand();
+void mission_command_priority_out_event_data_send(data_t *data);
+void sendMissionCommand(vehicle_t *vehicle);
 
 void initializeWaypointManager() {
-  currentWaypoint = 0;
-  currentCommand = INIT_CMD_ID;
   returnHome = false;
-  automationResponse = NULL;
   homeWaypoint = NULL;
+  vehicle_table_init(&vehicleTable);
+  missionCount = 0;
+  mission_command_waypoints_init(&homeWaypoints);
+  memset(&windowTransitionStats, 0, sizeof(windowTransitionStats));
+  timerFrequency = generic_timer_frequency();
 
   lmcp_init_Waypoint(&homeWaypoint);
   homeWaypoint->super.latitude = HOME_WAYPOINT_LAT;
@@ -69,76 +133,186 @@ void initializeWaypointManager() {
   homeWaypoint->contingencywaypointb = 0;
   homeWaypoint->associatedtasks_ai.length = 0;
 
+  if (!mission_command_waypoints_load(&homeWaypoints, &homeWaypoint, 1)) {
+    printf("%s: could not encode home waypoint\n", get_instance_name()); fflush(stdout);
+  }
+
 }
 
-Waypoint * FindWaypoint(Waypoint ** ws,
-                        uint16_t len,
-                        int64_t id) {
+//------------------------------------------------------------------------------
+// Vehicles
+
+static void initializeVehicle(vehicle_t *vehicle, int64_t id) {
+  vehicle->id = id;
+  vehicle->mission = NULL;
+  waypoint_index_init(&vehicle->waypointIndex);
+  mission_command_waypoints_init(&vehicle->missionWaypoints);
+  vehicle->currentWaypoint = 0;
+  vehicle->currentCommand = INIT_CMD_ID;
+  vehicle->stagedWindowLength = 0;
+
+  char attributes[MISSION_COMMAND_ATTRIBUTES_MAX];
+  snprintf(attributes, sizeof(attributes), MISSION_COMMAND_ATTRIBUTES_FORMAT, (long long) id);
+  if (!mission_command_encoder_init(&vehicle->missionCommandEncoder, attributes, id, 1)) {
+    printf("%s: could not build mission command template for vehicle %lld\n", get_instance_name(), (long long) id);
+    fflush(stdout);
+  }
 
-  for (uint16_t i = 0 ; i < len; i++) {
-    if (ws[i]->number == id) {
-      return ws[i];
-    }
+  // The return home command is the home waypoint for the whole window
+  uint32_t homeWindow[WINDOW_SIZE] = { 0 };
+  vehicle->returnHomeMessageLength =
+    mission_command_encoder_encode(&vehicle->missionCommandEncoder, &homeWaypoints, homeWindow, WINDOW_SIZE,
+                                   0, HOME_WAYPOINT_NUM,
+                                   vehicle->returnHomeMessage.payload, sizeof(vehicle->returnHomeMessage.payload));
+  if (vehicle->returnHomeMessageLength == 0) {
+    printf("%s: could not build return home command for vehicle %lld\n", get_instance_name(), (long long) id);
+    fflush(stdout);
   }
-  return NULL;
 }
 
 
-bool IsWaypointInWindow( Waypoint ** waypointList,
-                      uint16_t waypointListSize,
-                      uint16_t windowSize,
-                      int64_t startId,
-                      int64_t id) {
-  int64_t nid = startId;
-  Waypoint * wp = NULL;
+// The vehicle with id, or NULL if the WaypointManager is not tracking it
+static vehicle_t *findVehicle(int64_t id) {
+  uint32_t entry = vehicle_table_find(&vehicleTable, id);
+  return (entry != VEHICLE_TABLE_NONE) ? &vehicles[entry] : NULL;
+}
 
-  for (int i = 0; i < windowSize; i++) {
-    wp = FindWaypoint(waypointList, waypointListSize, nid);
-    if (wp != NULL) {
-      if (wp->number == id) {
-        return true;
-      }
-      nid = wp->nextwaypoint;
-    } else {
-      return false;
-    }
+
+// The vehicle with id, starting to track it if need be.  NULL if there is no
+// room for another vehicle.
+static vehicle_t *addVehicle(int64_t id) {
+  uint32_t count = vehicleTable.count;
+  uint32_t entry = vehicle_table_insert(&vehicleTable, id);
+  if (entry == VEHICLE_TABLE_NONE) {
+    printf("%s: no room for vehicle %lld\n", get_instance_name(), (long long) id); fflush(stdout);
+    return NULL;
+  }
+  if (vehicleTable.count != count) {
+    initializeVehicle(&vehicles[entry], id);
   }
-  return false;
+  return &vehicles[entry];
 }
 
 
-/* NB: Cycles in ws will be unrolled into win. */
-bool FillWindow(  Waypoint ** ws,
-                  uint16_t len_ws,
-                  int64_t id,
-                  Waypoint ** ws_win, /* out */
-                  uint16_t len_ws_win) {
-  uint16_t i;
-  int64_t nid = id;
-  Waypoint * wp = NULL;
-  bool success = true;
-
-  for(i=0; i < len_ws_win && success == true; i++) {
-    success = false;
-    wp = FindWaypoint(ws, len_ws, nid);
-    if(wp != NULL) {
-      success = true;
-      ws_win[i] = wp;
-      nid = ws_win[i]->nextwaypoint;
-    }
+static void clearMission(vehicle_t *vehicle) {
+  if (vehicle->mission != NULL) {
+    waypoint_index_clear(&vehicle->waypointIndex);
+    mission_command_waypoints_clear(&vehicle->missionWaypoints);
+    lmcp_free_MissionCommand(vehicle->mission, 1);
+    vehicle->mission = NULL;
+    vehicle->stagedWindowLength = 0;
+    missionCount--;
+  }
+}
+
+
+// Replace the vehicle's mission, taking ownership of it, and send its first
+// window
+static void setMission(vehicle_t *vehicle, MissionCommand *mission) {
+  clearMission(vehicle);
+
+  if (waypoint_index_build(&vehicle->waypointIndex,
+                           mission->waypointlist,
+                           mission->waypointlist_ai.length,
+                           mission->firstwaypoint,
+                           WINDOW_SIZE)
+      && mission_command_waypoints_load(&vehicle->missionWaypoints,
+                                        mission->waypointlist,
+                                        mission->waypointlist_ai.length)) {
+
+    vehicle->mission = mission;
+    missionCount++;
+    vehicle->currentWaypoint = mission->firstwaypoint;
+    sendMissionCommand(vehicle);
+
+  } else {
+    printf("%s: automation response rx handler: invalid mission command for vehicle %lld\n",
+           get_instance_name(), (long long) vehicle->id); fflush(stdout);
+    waypoint_index_clear(&vehicle->waypointIndex);
+    lmcp_free_MissionCommand(mission, 1);
   }
-  return success;
 }
 
+//------------------------------------------------------------------------------
+// Window transitions
+
+static uint64_t ticksToMicroseconds(uint64_t ticks) {
+  return (timerFrequency > 0) ? ticks * 1000000 / timerFrequency : ticks;
+}
+
+
+static void reportWindowTransitions(void) {
+  window_transition_stats_t *stats = &windowTransitionStats;
+  printf("%s: window transitions %u (%u staged, %u early), latency last %llu us, mean %llu us, max %llu us%s\n",
+         get_instance_name(), stats->count, stats->staged, stats->early,
+         (unsigned long long) ticksToMicroseconds(stats->last),
+         (unsigned long long) ticksToMicroseconds(stats->total / stats->count),
+         (unsigned long long) ticksToMicroseconds(stats->max),
+         (timerFrequency > 0) ? "" : " (timer unavailable)");
+  fflush(stdout);
+}
+
+
+static void recordWindowTransition(uint64_t received, bool early) {
+  uint64_t latency = generic_timer_count() - received;
+  window_transition_stats_t *stats = &windowTransitionStats;
+  stats->count++;
+  stats->early += early ? 1 : 0;
+  stats->total += latency;
+  stats->last = latency;
+  if (latency > stats->max) {
+    stats->max = latency;
+  }
+
+  if (window_transition_report_interval > 0 && stats->count % window_transition_report_interval == 0) {
+    reportWindowTransitions();
+  }
+}
+
+
+// Encode the window that follows the current one, starting at the first
+// overlapping waypoint, so that the transition only patches in the command id
+static void stageNextWindow(vehicle_t *vehicle, const uint32_t *window, uint32_t windowLength) {
+  if (vehicle->stagedWindowLength > 0 && vehicle->stagedWindowFrom == vehicle->currentWaypoint) {
+    return;
+  }
+  vehicle->stagedWindowLength = 0;
+  if (windowLength <= WINDOW_SIZE - WINDOW_OVERLAP) {
+    return;
+  }
+
+  int64_t start = vehicle->waypointIndex.waypoints[window[WINDOW_SIZE - WINDOW_OVERLAP]]->number;
+  uint32_t next[WINDOW_SIZE];
+  uint32_t nextLength = waypoint_index_route(&vehicle->waypointIndex, start, next, WINDOW_SIZE);
+  vehicle->stagedWindowLength =
+    mission_command_encoder_encode(&vehicle->missionCommandEncoder, &vehicle->missionWaypoints, next, nextLength,
+                                   0, start, vehicle->stagedWindow.payload, sizeof(vehicle->stagedWindow.payload));
+  vehicle->stagedWindowStart = start;
+  vehicle->stagedWindowFrom = vehicle->currentWaypoint;
+}
+
+
+// Position of the waypoint numbered number among the first count of window,
+// or count if it is not there
+static uint32_t windowPosition(const vehicle_t *vehicle, const uint32_t *window, uint32_t count, int64_t number) {
+  uint32_t target = waypoint_index_find(&vehicle->waypointIndex, number);
+  uint32_t i = 0;
+  while (i < count && window[i] != target) {
+    ++i;
+  }
+  return i;
+}
 
 //------------------------------------------------------------------------------
 // User specified input data receive handler for AADL Input Event Data Port (in) named
 // "p1_in".
 void air_vehicle_state_in_event_data_receive_handler(counter_t numDropped, data_t *data) {
 
+  uint64_t received = generic_timer_count();
+
 //  printf("\n%s: received air vehicle state\n", get_instance_name()); fflush(stdout);
-  
-  if (automationResponse == NULL && !returnHome) {
+
+  if (missionCount == 0 && !returnHome) {
     return;
   }
 
@@ -151,11 +325,16 @@ void air_vehicle_state_in_event_data_receive_handler(counter_t numDropped, data_
 
     if (msg_result == 0) {
 
-//      printf("AirVehicleState waypoint = %llu, currentWaypoint = %llu\n", airVehicleState->super.currentwaypoint, currentWaypoint);
+//      printf("AirVehicleState waypoint = %llu\n", airVehicleState->super.currentwaypoint);
 //      fflush(stdout);
 //      hexdump_raw(24, data->payload, compute_addr_attr_lmcp_message_size(data->payload, sizeof(data->payload)));
 
-      if (airVehicleState->super.currentwaypoint == 0 && !returnHome) {
+      // Any vehicle may be sent home, only those with a mission get windows
+      vehicle_t *vehicle = returnHome ? addVehicle(airVehicleState->super.id)
+                                      : findVehicle(airVehicleState->super.id);
+
+      if (vehicle == NULL || (vehicle->mission == NULL && !returnHome)
+          || (airVehicleState->super.currentwaypoint == 0 && !returnHome)) {
         lmcp_free_AirVehicleState(airVehicleState, 1);
         return;
       }
@@ -163,20 +342,34 @@ void air_vehicle_state_in_event_data_receive_handler(counter_t numDropped, data_
       // Check to see if we need to return home
       if (returnHome) {
         if (airVehicleState->super.currentwaypoint != HOME_WAYPOINT_NUM) {
-          currentWaypoint = HOME_WAYPOINT_NUM;
-          sendMissionCommand();
+          vehicle->currentWaypoint = HOME_WAYPOINT_NUM;
+          sendMissionCommand(vehicle);
         }
       } else {
 
-        bool waypointInWindow = IsWaypointInWindow(automationResponse->missioncommandlist[0]->waypointlist,
-                                              automationResponse->missioncommandlist[0]->waypointlist_ai.length,
-                                              WINDOW_SIZE - WINDOW_OVERLAP,
-                                              currentWaypoint,
-                                              airVehicleState->super.currentwaypoint);
-
-        if (!waypointInWindow) {
-          currentWaypoint = airVehicleState->super.currentwaypoint;
-          sendMissionCommand();
+        // Where the vehicle is in the non-overlapping part of the window,
+        // the window moves once it is past it
+        uint32_t window[WINDOW_SIZE];
+        uint32_t windowLength = waypoint_index_route(&vehicle->waypointIndex, vehicle->currentWaypoint,
+                                                     window, WINDOW_SIZE);
+        uint32_t nonOverlap = (windowLength < WINDOW_SIZE - WINDOW_OVERLAP) ? windowLength : WINDOW_SIZE - WINDOW_OVERLAP;
+        uint32_t position = windowPosition(vehicle, window, nonOverlap, airVehicleState->super.currentwaypoint);
+
+        uint32_t lead = (window_prestage_lead < 1) ? 1 : (uint32_t) window_prestage_lead;
+        bool nearingOverlap = position + lead >= WINDOW_SIZE - WINDOW_OVERLAP;
+
+        if (position == nonOverlap) {
+          vehicle->currentWaypoint = airVehicleState->super.currentwaypoint;
+          sendMissionCommand(vehicle);
+          recordWindowTransition(received, false);
+        } else if (nearingOverlap && window_prestage_policy == WINDOW_PRESTAGE_COMMIT) {
+          stageNextWindow(vehicle, window, windowLength);
+        } else if (nearingOverlap && window_prestage_policy == WINDOW_PRESTAGE_EARLY && position > 0) {
+          // Start the new window at the vehicle's waypoint rather than the
+          // predicted one, so no waypoint ahead of the vehicle is dropped
+          vehicle->currentWaypoint = airVehicleState->super.currentwaypoint;
+          sendMissionCommand(vehicle);
+          recordWindowTransition(received, true);
         }
       }
 
@@ -205,16 +398,16 @@ bool air_vehicle_state_in_event_data_poll(counter_t *numDropped, data_t *data) {
 //------------------------------------------------------------------------------
 // User specified input data receive handler for AADL Input Event Data Port (in) named
 // "automation_response_in".
+//
+// Each MissionCommand goes to the vehicle it names, replacing that vehicle's
+// mission.  Vehicles the AutomationResponse does not mention keep theirs.
 void automation_response_in_event_data_receive_handler(counter_t numDropped, data_t *data) {
 
     printf("\n%s: received automation response\n", get_instance_name()); fflush(stdout);
-    
-    if (automationResponse != NULL) {
-        lmcp_free_AutomationResponse(automationResponse, 1);
-        automationResponse = NULL;
-    }
+
+    AutomationResponse *automationResponse = NULL;
     lmcp_init_AutomationResponse(&automationResponse);
-    
+
     uint8_t *payload = &(data->payload[0]);
 
     int msg_result = lmcp_process_msg(&payload, sizeof(data->payload), (lmcp_object**)&automationResponse);
@@ -223,15 +416,21 @@ void automation_response_in_event_data_receive_handler(counter_t numDropped, dat
 
 //        hexdump_raw(24, data->payload, compute_addr_attr_lmcp_message_size(data->payload, sizeof(data->payload)));
 
-        currentWaypoint = automationResponse->missioncommandlist[0]->firstwaypoint;
-        sendMissionCommand();
+        for (uint32_t i = 0; i < automationResponse->missioncommandlist_ai.length; ++i) {
+          MissionCommand *mission = automationResponse->missioncommandlist[i];
+          vehicle_t *vehicle = (mission != NULL) ? addVehicle(mission->super.vehicleid) : NULL;
+          if (vehicle != NULL) {
+            automationResponse->missioncommandlist[i] = NULL;
+            setMission(vehicle, mission);
+          }
+        }
 
     } else {
       printf("%s: automation response rx handler: invalid automation response\n", get_instance_name()); fflush(stdout);
-      lmcp_free_AutomationResponse(automationResponse, 1);
-      automationResponse = NULL;
     }
 
+    lmcp_free_AutomationResponse(automationResponse, 1);
+
 }
 
 
@@ -277,103 +476,133 @@ void mission_command_out_event_data_send(data_t *data) {
     done_emit();
 }
 
-const char mission_command_attributes[] = "afrl.cmasi.MissionCommand$lmcp|afrl.cmasi.MissionCommand||400|63$";
+void mission_command_priority_out_event_data_send(data_t *data) {
+    queue_enqueue(mission_command_priority_out_queue, data);
+    mission_command_priority_out_SendEvent_emit();
+    done_emit();
+}
 
-void sendMissionCommand() {
+void sendMissionCommand(vehicle_t *vehicle) {
 
     // Don't do anything if current waypoint is 0.
     // Something is wrong.  This method should not have been called.
-//    if (currentWaypoint == 0) {
+//    if (vehicle->currentWaypoint == 0) {
 //        printf("%s: sendMissionCommand(): currentWaypoint == 0\n", get_instance_name()); fflush(stdout);
 //        return;
 //    }
-  
+
     // Don't do anything until an AutomationResponse is recevied
-//    if (automationResponse == NULL) {
-//        printf("%s: sendMissionCommand(): automationResponse == NULL\n", get_instance_name()); fflush(stdout);
+//    if (vehicle->mission == NULL) {
+//        printf("%s: sendMissionCommand(): mission == NULL\n", get_instance_name()); fflush(stdout);
 //        return;
 //    }
 
 //    printf("%s: sendMissionCommand()\n", get_instance_name()); fflush(stdout);
 
-    // Construct mission command message
-    MissionCommand * missionCommand = NULL;
-    lmcp_init_MissionCommand(&missionCommand);
-//    missionCommand->super = automationResponse->missioncommandlist[0]->super;
-    missionCommand->super.vehicleid = VEHICLE_ID;
-    missionCommand->super.commandid = currentCommand++;
-    missionCommand->super.status = 1;
-    missionCommand->super.vehicleactionlist_ai.length = 0;
-    missionCommand->waypointlist_ai.length = WINDOW_SIZE;
-    missionCommand->waypointlist = malloc(sizeof(Waypoint*) * WINDOW_SIZE);
+    data_t* data = calloc(1, sizeof(data_t));
+    if (data == NULL) {
+      printf("%s: sendMissionCommand(): could not allocate data buffer\n", get_instance_name()); fflush(stdout);
+      return;
+    }
 
+    size_t length = 0;
     if (returnHome) {
-      currentWaypoint = HOME_WAYPOINT_NUM;
-      // Set mission window waypoints to home
-      for (int i = 0; i < WINDOW_SIZE; i++) {
-          missionCommand->waypointlist[i] = homeWaypoint;
-      }
+      vehicle->currentWaypoint = HOME_WAYPOINT_NUM;
+      // Precomputed, only the command id changes
+      length = vehicle->returnHomeMessageLength;
+      memcpy(data->payload, vehicle->returnHomeMessage.payload, length);
+      mission_command_encoder_set_command_id(&vehicle->missionCommandEncoder, data->payload, length,
+                                             vehicle->currentCommand++);
+    } else if (vehicle->stagedWindowLength > 0 && vehicle->stagedWindowStart == vehicle->currentWaypoint) {
+      // The window was predicted, commit it
+      length = vehicle->stagedWindowLength;
+      memcpy(data->payload, vehicle->stagedWindow.payload, length);
+      mission_command_encoder_set_command_id(&vehicle->missionCommandEncoder, data->payload, length,
+                                             vehicle->currentCommand++);
+      windowTransitionStats.staged++;
     } else {
-      // Construct mission window
-      FillWindow( automationResponse->missioncommandlist[0]->waypointlist,
-                  automationResponse->missioncommandlist[0]->waypointlist_ai.length,
-                  currentWaypoint,
-                  missionCommand->waypointlist,
-                  WINDOW_SIZE);
+      // Construct mission window from the pre-encoded waypoints, short if the
+      // route runs out of waypoints
+      uint32_t window[WINDOW_SIZE];
+      uint32_t windowLength = waypoint_index_route(&vehicle->waypointIndex, vehicle->currentWaypoint,
+                                                   window, WINDOW_SIZE);
+      length = mission_command_encoder_encode(&vehicle->missionCommandEncoder, &vehicle->missionWaypoints,
+                                              window, windowLength,
+                                              vehicle->currentCommand++, vehicle->currentWaypoint,
+                                              data->payload, sizeof(data->payload));
     }
 
-    missionCommand->firstwaypoint = currentWaypoint;
-    AddressAttributedMessage * addressAttributedMessage = NULL;
-
-    lmcp_init_AddressAttributedMessage(&addressAttributedMessage);
-    addressAttributedMessage->attributes = mission_command_attributes;
-    addressAttributedMessage->lmcp_obj = (lmcp_object*)missionCommand;
-
-    data_t* data = calloc(1, sizeof(data_t));
-    if (data != NULL) {
-      lmcp_pack_AddressAttributedMessage(data->payload, addressAttributedMessage);
+    if (length > 0) {
 
 //      hexdump_raw(24, data->payload, compute_addr_attr_lmcp_message_size(data->payload, sizeof(data->payload)));
 
-      // Send it
-      mission_command_out_event_data_send(data);
-
-      free(data);
+      // Send it, return home on the priority port so it overtakes any
+      // routine window still waiting in the APSS
+      if (returnHome) {
+        mission_command_priority_out_event_data_send(data);
+      } else {
+        mission_command_out_event_data_send(data);
+      }
     } else {
-      printf("%s: sendMissionCommand(): could not allocate data buffer\n", get_instance_name()); fflush(stdout);
+      printf("%s: sendMissionCommand(): mission command does not fit in data buffer\n", get_instance_name()); fflush(stdout);
     }
 
-    lmcp_free_AddressAttributedMessage(addressAttributedMessage, 1);
+    free(data);
+    vehicle->stagedWindowLength = 0;
 
 }
 
 
 
-void run_poll(void) {
+// Ports are serviced one message at a time, so a handler is done with the
+// message before the next is dequeued into the same buffer
+static data_t portData;
+
+static bool service_return_home_in(void *context) {
+    (void) context;
     counter_t numDropped;
-    data_t data;
+    if (!return_home_in_event_data_poll(&numDropped, &portData)) {
+        return false;
+    }
+    returnHome = true;
+    return true;
+}
 
-    while (true) {
+static bool service_automation_response_in(void *context) {
+    (void) context;
+    counter_t numDropped;
+    if (!automation_response_in_event_data_poll(&numDropped, &portData)) {
+        return false;
+    }
+    automation_response_in_event_data_receive_handler(numDropped, &portData);
+    return true;
+}
 
-        bool dataReceived = false;
+// Air vehicle state is left queued until there is a mission to follow
+static bool service_air_vehicle_state_in(void *context) {
+    (void) context;
+    counter_t numDropped;
+    if (!(returnHome || missionCount > 0) || !air_vehicle_state_in_event_data_poll(&numDropped, &portData)) {
+        return false;
+    }
+    air_vehicle_state_in_event_data_receive_handler(numDropped, &portData);
+    return true;
+}
 
-        dataReceived = return_home_in_event_data_poll(&numDropped, &data);
-        if (dataReceived) {
-            returnHome = true;
-        }
-        
-        if (returnHome || automationResponse != NULL) {
-          dataReceived = air_vehicle_state_in_event_data_poll(&numDropped, &data);
-          if (dataReceived) {
-              air_vehicle_state_in_event_data_receive_handler(numDropped, &data);
-          }
-        }
+port_executive_t portExecutive;
 
-        dataReceived = automation_response_in_event_data_poll(&numDropped, &data);
-        if (dataReceived) {
-            automation_response_in_event_data_receive_handler(numDropped, &data);
-        }
+void run_poll(void) {
+
+    port_executive_init(&portExecutive);
+    port_executive_add(&portExecutive, "return_home_in", PORT_PRIORITY_SAFETY,
+                       service_return_home_in, NULL, PORT_EXECUTIVE_DRAIN);
+    port_executive_add(&portExecutive, "automation_response_in", PORT_PRIORITY_COMMAND,
+                       service_automation_response_in, NULL, PORT_EXECUTIVE_DRAIN);
+    port_executive_add(&portExecutive, "air_vehicle_state_in", PORT_PRIORITY_TELEMETRY,
+                       service_air_vehicle_state_in, NULL, AIR_VEHICLE_STATE_IN_BUDGET);
 
+    while (true) {
+        port_executive_service(&portExecutive);
         seL4_Yield();
     }
 
@@ -386,6 +615,7 @@ void post_init(void) {
     recv_queue_init(&automationResponseInRecvQueue, automation_response_in_queue);
     recv_queue_init(&returnHomeInRecvQueue, return_home_in_queue);
     queue_init(mission_command_out_queue);
+    queue_init(mission_command_priority_out_queue);
 }
 
 int run(void) {
@@ -397,4 +627,3 @@ int run(void) {
     run_poll();
 
 }
-
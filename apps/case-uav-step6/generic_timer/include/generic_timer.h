@@ -0,0 +1,47 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+
+/**
+ * The ARM generic timer's virtual count, read directly at user level so a
+ * component can time its own work without a call into the time server, which
+ * runs in another scheduling domain.  User access requires the kernel to be
+ * configured with KernelArmExportVCNTUser (see settings.cmake).  Elsewhere the
+ * count and frequency both read as 0.
+ */
+static inline uint64_t generic_timer_count(void) {
+#if defined(__arm__)
+  uint32_t low, high;
+  asm volatile("isb; mrrc p15, 1, %0, %1, c14" : "=r"(low), "=r"(high) : : "memory");
+  return ((uint64_t) high << 32) | low;
+#elif defined(__aarch64__)
+  uint64_t count;
+  asm volatile("isb; mrs %0, cntvct_el0" : "=r"(count) : : "memory");
+  return count;
+#else
+  return 0;
+#endif
+}
+
+
+/**
+ * Ticks per second of generic_timer_count().
+ */
+static inline uint32_t generic_timer_frequency(void) {
+#if defined(__arm__)
+  uint32_t frequency;
+  asm volatile("mrc p15, 0, %0, c14, c0, 0" : "=r"(frequency));
+  return frequency;
+#elif defined(__aarch64__)
+  uint64_t frequency;
+  asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+  return (uint32_t) frequency;
+#else
+  return 0;
+#endif
+}
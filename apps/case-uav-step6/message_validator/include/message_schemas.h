@@ -0,0 +1,27 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+// Schemas of the messages the filters pass from the radio to UxAS, following
+// the CMASI wire layout and the bounds of the CakeML filters.
+
+#pragma once
+
+#include <stdint.h>
+
+#include "message_validator.h"
+
+
+// CMASI types the generated C library does not cover
+#define OPERATING_REGION_TYPE 39
+#define AUTOMATION_REQUEST_TYPE 40
+
+
+extern const validator_field_t line_search_task_schema[];
+extern const uint32_t line_search_task_schema_size;
+
+extern const validator_field_t operating_region_schema[];
+extern const uint32_t operating_region_schema_size;
+
+extern const validator_field_t automation_request_schema[];
+extern const uint32_t automation_request_schema_size;
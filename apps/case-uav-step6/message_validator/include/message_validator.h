@@ -0,0 +1,123 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+// Validation of LMCP messages against a schema, without decoding them.
+//
+// A schema is a table of the fields of a message in the order they are sent,
+// each with its type and, optionally, the range or enumeration values it must
+// lie in and the most elements it may have.  validator_compile turns the table
+// into a flat program, working out where each list's element ends and which
+// elements are of fixed size.  validator_check then walks the message octets
+// with the program, allocating nothing.
+//
+// The elements of a list of fixed size, whether numbers or objects of numeric
+// fields such as Location3D, are checked in bulk: each checked field is
+// gathered across a run of elements and range checked four lanes at a time
+// with NEON or SSE.  The lanes work in single precision on bounds narrowed to
+// lie strictly inside the field's range, so a lane that passes is certainly in
+// range; any other element, NaN included, is checked again exactly in double
+// precision.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+
+// Most entries of a schema, END entries excepted
+#define VALIDATOR_MAX_OPS 64
+
+// Deepest nesting of lists and objects in a schema
+#define VALIDATOR_MAX_DEPTH 8
+
+
+typedef enum validator_type {
+  VALIDATOR_BOOL,
+  VALIDATOR_BYTE,
+  VALIDATOR_INT32,
+  VALIDATOR_UINT32,
+  VALIDATOR_INT64,
+  VALIDATOR_REAL32,
+  VALIDATOR_REAL64,
+  VALIDATOR_ENUM,             // an int32
+  VALIDATOR_STRING,           // uint16 length then the characters
+  VALIDATOR_ARRAY,            // uint16 length then the elements, each the entry that follows
+  VALIDATOR_OBJECT,           // an LMCP object, its fields the entries up to the matching END
+  VALIDATOR_END
+} validator_type_t;
+
+
+/**
+ * One entry of a schema.  Fields not named are zero.
+ */
+typedef struct validator_field {
+  const char *path;           // reported when the field is invalid
+  validator_type_t type;
+  bool range;                 // a number must lie in [min, max]
+  double min;
+  double max;
+  uint32_t enum_set;          // an ENUM must have bit value set; 0 allows any value
+  uint32_t bound;             // most elements of an ARRAY or STRING; 0 for no bound
+  uint32_t lmcp_type;         // type an OBJECT must have
+  bool required;              // an OBJECT may not be null
+} validator_field_t;
+
+
+typedef struct validator_op {
+  uint8_t type;
+  uint8_t width;              // octets of a number
+  bool range;
+  bool fixed;                 // a number, or an OBJECT of numbers only
+  uint16_t field;             // schema entry checked
+  uint16_t next;              // op after an ARRAY's element or an OBJECT's fields
+  uint32_t offset;            // octets of a number into the fields of its fixed OBJECT
+  uint32_t size;              // octets of a fixed number, or the fields of a fixed OBJECT
+  uint32_t enum_set;
+  uint32_t bound;
+  uint32_t lmcp_type;
+  bool required;
+  float lane_min;             // range narrowed to single precision, for the lanes
+  float lane_max;
+  double min;
+  double max;
+} validator_op_t;
+
+
+typedef struct validator {
+  const validator_field_t *fields;
+  uint32_t count;
+  validator_op_t ops[VALIDATOR_MAX_OPS];
+} validator_t;
+
+
+typedef struct validator_result {
+  const char *path;           // field found invalid or cut short, or NULL if there is no LMCP object
+  size_t offset;              // octets into the object at which it was found
+  uint32_t index;             // element of the innermost list, if in one
+} validator_result_t;
+
+
+/**
+ * Compile the count entries of fields, which must outlive validator.  Returns
+ * false if the schema is malformed or too large, leaving a validator that
+ * rejects every message.
+ */
+bool validator_compile(validator_t *validator, const validator_field_t *fields, uint32_t count);
+
+
+/**
+ * Check the LMCP object of size octets at object, as found by lmcp_find_msg.
+ * Returns false, filling in result, if it does not match the schema or does
+ * not end with its last field.
+ */
+bool validator_check(const validator_t *validator, const uint8_t *object, size_t size,
+                     validator_result_t *result);
+
+
+/**
+ * Check the LMCP object of the address attributed message of size octets.
+ */
+bool validator_check_message(const validator_t *validator, const uint8_t *message, size_t size,
+                             validator_result_t *result);
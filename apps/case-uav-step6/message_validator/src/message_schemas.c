@@ -0,0 +1,92 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "KeyValuePair.h"
+#include "LineSearchTask.h"
+#include "Location3D.h"
+#include "Wedge.h"
+
+#include "message_schemas.h"
+
+
+#define SCHEMA_SIZE(schema) ((uint32_t) (sizeof(schema) / sizeof(validator_field_t)))
+
+// AltitudeType: AGL, MSL
+#define ALTITUDE_TYPES 0x3
+
+// WavelengthBand: AllAny, EO, LWIR, SWIR, MWIR, Other
+#define WAVELENGTH_BANDS 0x3F
+
+
+const validator_field_t line_search_task_schema[] = {
+  { "LineSearchTask", VALIDATOR_OBJECT, .lmcp_type = LMCP_LineSearchTask_TYPE, .required = true },
+
+  // Task
+  { "TaskID", VALIDATOR_INT64, .range = true, .min = 0, .max = 2000 },
+  { "Label", VALIDATOR_STRING },
+  { "EligibleEntities", VALIDATOR_ARRAY, .bound = 32 },
+  { "EligibleEntities[]", VALIDATOR_INT64 },
+  { "RevisitRate", VALIDATOR_REAL32 },
+  { "Parameters", VALIDATOR_ARRAY, .bound = 8 },
+  { "Parameters[]", VALIDATOR_OBJECT, .lmcp_type = LMCP_KeyValuePair_TYPE },
+  { "Parameters[].Key", VALIDATOR_STRING },
+  { "Parameters[].Value", VALIDATOR_STRING },
+  { NULL, VALIDATOR_END },
+  { "Priority", VALIDATOR_BYTE },
+  { "Required", VALIDATOR_BOOL },
+
+  // SearchTask
+  { "DesiredWavelengthBands", VALIDATOR_ARRAY, .bound = 8 },
+  { "DesiredWavelengthBands[]", VALIDATOR_ENUM, .enum_set = WAVELENGTH_BANDS },
+  { "DwellTime", VALIDATOR_INT64 },
+  { "GroundSampleDistance", VALIDATOR_REAL32 },
+
+  // LineSearchTask
+  { "PointList", VALIDATOR_ARRAY, .bound = 1024 },
+  { "PointList[]", VALIDATOR_OBJECT, .lmcp_type = LMCP_Location3D_TYPE },
+  { "PointList[].Latitude", VALIDATOR_REAL64, .range = true, .min = -90.0, .max = 90.0 },
+  { "PointList[].Longitude", VALIDATOR_REAL64, .range = true, .min = -180.0, .max = 180.0 },
+  { "PointList[].Altitude", VALIDATOR_REAL32, .range = true, .min = 0.0, .max = 5000.0 },
+  { "PointList[].AltitudeType", VALIDATOR_ENUM, .enum_set = ALTITUDE_TYPES },
+  { NULL, VALIDATOR_END },
+  { "ViewAngleList", VALIDATOR_ARRAY, .bound = 16 },
+  { "ViewAngleList[]", VALIDATOR_OBJECT, .lmcp_type = LMCP_Wedge_TYPE },
+  { "ViewAngleList[].AzimuthCenterline", VALIDATOR_REAL32, .range = true, .min = -180.0, .max = 180.0 },
+  { "ViewAngleList[].VerticalCenterline", VALIDATOR_REAL32, .range = true, .min = -180.0, .max = 180.0 },
+  { "ViewAngleList[].AzimuthExtent", VALIDATOR_REAL32 },
+  { "ViewAngleList[].VerticalExtent", VALIDATOR_REAL32 },
+  { NULL, VALIDATOR_END },
+  { "UseInertialViewAngles", VALIDATOR_BOOL },
+  { NULL, VALIDATOR_END }
+};
+const uint32_t line_search_task_schema_size = SCHEMA_SIZE(line_search_task_schema);
+
+
+const validator_field_t operating_region_schema[] = {
+  { "OperatingRegion", VALIDATOR_OBJECT, .lmcp_type = OPERATING_REGION_TYPE, .required = true },
+  { "ID", VALIDATOR_INT64 },
+  { "KeepInAreas", VALIDATOR_ARRAY, .bound = 32 },
+  { "KeepInAreas[]", VALIDATOR_INT64 },
+  { "KeepOutAreas", VALIDATOR_ARRAY, .bound = 32 },
+  { "KeepOutAreas[]", VALIDATOR_INT64 },
+  { NULL, VALIDATOR_END }
+};
+const uint32_t operating_region_schema_size = SCHEMA_SIZE(operating_region_schema);
+
+
+const validator_field_t automation_request_schema[] = {
+  { "AutomationRequest", VALIDATOR_OBJECT, .lmcp_type = AUTOMATION_REQUEST_TYPE, .required = true },
+  { "EntityList", VALIDATOR_ARRAY, .bound = 16 },
+  { "EntityList[]", VALIDATOR_INT64 },
+  { "TaskList", VALIDATOR_ARRAY, .bound = 32 },
+  { "TaskList[]", VALIDATOR_INT64 },
+  { "TaskRelationships", VALIDATOR_STRING },
+  { "OperatingRegion", VALIDATOR_INT64 },
+  { "RedoAllTasks", VALIDATOR_BOOL },
+  { NULL, VALIDATOR_END }
+};
+const uint32_t automation_request_schema_size = SCHEMA_SIZE(automation_request_schema);
@@ -0,0 +1,503 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define VALIDATOR_NEON
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#define VALIDATOR_SSE
+#endif
+
+#include "lmcp.h"
+
+#include "message_validator.h"
+
+
+#define LANES 4
+
+// Elements of a fixed size list gathered at a time
+#define RUN 64
+
+// isnull, series name, type and version preceding an object's fields
+#define HEADER_SIZE 15
+#define HEADER_TYPE_OFFSET 9
+
+
+typedef struct walk {
+  const validator_t *validator;
+  const uint8_t *object;
+  size_t size;
+  size_t position;
+  validator_result_t *result;
+} walk_t;
+
+
+//------------------------------------------------------------------------------
+// Numbers
+
+static inline uint32_t get_uint16(const uint8_t *p) {
+  return ((uint32_t) p[0] << 8) | p[1];
+}
+
+
+static inline uint32_t get_uint32(const uint8_t *p) {
+  return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | p[3];
+}
+
+
+static inline uint64_t get_uint64(const uint8_t *p) {
+  return ((uint64_t) get_uint32(p) << 32) | get_uint32(p + 4);
+}
+
+
+// The number of type at p, exactly but for int64s beyond 2^53, which round
+// to the nearest double and so still compare correctly with integral bounds
+static inline double value_of(uint8_t type, const uint8_t *p) {
+  switch (type) {
+  case VALIDATOR_INT32:
+  case VALIDATOR_ENUM:
+    return (int32_t) get_uint32(p);
+  case VALIDATOR_UINT32:
+    return get_uint32(p);
+  case VALIDATOR_INT64:
+    return (double) (int64_t) get_uint64(p);
+  case VALIDATOR_REAL32: {
+    uint32_t bits = get_uint32(p);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+  case VALIDATOR_REAL64: {
+    uint64_t bits = get_uint64(p);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+  default:
+    return p[0];
+  }
+}
+
+
+static inline bool number_valid(const validator_op_t *op, const uint8_t *p) {
+  if (op->type == VALIDATOR_ENUM && op->enum_set != 0) {
+    int32_t value = (int32_t) get_uint32(p);
+    if (value < 0 || value > 31 || ((op->enum_set >> value) & 1) == 0) {
+      return false;
+    }
+  }
+  if (op->range) {
+    // False for NaN
+    double value = value_of(op->type, p);
+    return value >= op->min && value <= op->max;
+  }
+  return true;
+}
+
+
+static inline bool checked(const validator_op_t *op) {
+  return op->range || (op->type == VALIDATOR_ENUM && op->enum_set != 0);
+}
+
+
+static uint8_t width_of(validator_type_t type) {
+  switch (type) {
+  case VALIDATOR_BOOL:
+  case VALIDATOR_BYTE:
+    return 1;
+  case VALIDATOR_INT32:
+  case VALIDATOR_UINT32:
+  case VALIDATOR_REAL32:
+  case VALIDATOR_ENUM:
+    return 4;
+  case VALIDATOR_INT64:
+  case VALIDATOR_REAL64:
+    return 8;
+  default:
+    return 0;
+  }
+}
+
+
+// The float next to value, up or down
+static float float_step(float value, bool up) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  if (value == 0.0f) {
+    bits = up ? 0x00000001 : 0x80000001;
+  } else if ((value > 0.0f) == up) {
+    bits++;
+  } else {
+    bits--;
+  }
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+
+//------------------------------------------------------------------------------
+// Range lanes
+//
+// Rounding to single precision is monotonic, so a value whose float lies
+// strictly between lane_min and lane_max, themselves within [min, max], lies
+// in [min, max].  A value that does not may still be in range and is checked
+// exactly.
+
+static inline void set_bits(uint64_t *bitmap, uint32_t position, uint32_t bits) {
+  *bitmap |= (uint64_t) bits << position;
+}
+
+
+#if defined(VALIDATOR_NEON)
+
+// Bit i set for each lane i of mask set
+static inline uint32_t lane_bits(uint32x4_t mask) {
+  static const uint32_t weights[LANES] = { 1, 2, 4, 8 };
+  uint32x4_t bits = vandq_u32(mask, vld1q_u32(weights));
+  uint32x2_t sum = vadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+  return vget_lane_u32(vpadd_u32(sum, sum), 0);
+}
+
+
+static uint32_t within_lanes(const float *x, uint32_t count, float min, float max, uint64_t *bitmap) {
+  float32x4_t lo = vdupq_n_f32(min), hi = vdupq_n_f32(max);
+  uint32_t i = 0;
+  for (; i + LANES <= count; i += LANES) {
+    float32x4_t v = vld1q_f32(&x[i]);
+    set_bits(bitmap, i, lane_bits(vandq_u32(vcgtq_f32(v, lo), vcltq_f32(v, hi))));
+  }
+  return i;
+}
+
+#elif defined(VALIDATOR_SSE)
+
+static uint32_t within_lanes(const float *x, uint32_t count, float min, float max, uint64_t *bitmap) {
+  __m128 lo = _mm_set1_ps(min), hi = _mm_set1_ps(max);
+  uint32_t i = 0;
+  for (; i + LANES <= count; i += LANES) {
+    __m128 v = _mm_loadu_ps(&x[i]);
+    set_bits(bitmap, i, (uint32_t) _mm_movemask_ps(_mm_and_ps(_mm_cmpgt_ps(v, lo), _mm_cmplt_ps(v, hi))));
+  }
+  return i;
+}
+
+#else
+
+// No lanes: within checks every value itself
+static uint32_t within_lanes(const float *x, uint32_t count, float min, float max, uint64_t *bitmap) {
+  (void) x;
+  (void) count;
+  (void) min;
+  (void) max;
+  (void) bitmap;
+  return 0;
+}
+
+#endif
+
+
+// Bit i set for each of the count values of x, at most RUN, strictly within (min, max)
+static uint64_t within(const float *x, uint32_t count, float min, float max) {
+  uint64_t bitmap = 0;
+  for (uint32_t i = within_lanes(x, count, min, max, &bitmap); i < count; ++i) {
+    if (x[i] > min && x[i] < max) {
+      set_bits(&bitmap, i, 1);
+    }
+  }
+  return bitmap;
+}
+
+
+// Check the number of op at op->offset into each of the count elements,
+// setting failed to the first invalid one
+static bool check_run(const validator_op_t *op, const uint8_t *const *elements, uint32_t count, uint32_t *failed) {
+  uint64_t certain = 0;
+  if (op->range) {
+    float x[RUN];
+    for (uint32_t i = 0; i < count; ++i) {
+      x[i] = (float) value_of(op->type, elements[i] + op->offset);
+    }
+    certain = within(x, count, op->lane_min, op->lane_max);
+  }
+  for (uint32_t i = 0; i < count; ++i) {
+    if (((certain >> i) & 1) == 0 && !number_valid(op, elements[i] + op->offset)) {
+      *failed = i;
+      return false;
+    }
+  }
+  return true;
+}
+
+
+//------------------------------------------------------------------------------
+// Compiling
+
+// Close the lists whose element is now complete
+static void close_arrays(validator_t *validator, uint16_t *open, uint32_t *depth, uint32_t count) {
+  while (*depth > 0 && validator->ops[open[*depth - 1]].type == VALIDATOR_ARRAY) {
+    validator->ops[open[--*depth]].next = count;
+  }
+}
+
+
+// An object is fixed if its fields are all numbers; lay them out
+static void close_object(validator_t *validator, uint32_t first, uint32_t count) {
+  validator_op_t *object = &validator->ops[first];
+  object->next = count;
+  object->fixed = true;
+  object->size = 0;
+  for (uint32_t i = first + 1; i < count; ++i) {
+    if (validator->ops[i].width == 0) {
+      object->fixed = false;
+      return;
+    }
+  }
+  for (uint32_t i = first + 1; i < count; ++i) {
+    validator->ops[i].offset = object->size;
+    object->size += validator->ops[i].width;
+  }
+}
+
+
+bool validator_compile(validator_t *validator, const validator_field_t *fields, uint32_t count) {
+  memset(validator, 0, sizeof(*validator));
+  validator->fields = fields;
+
+  uint16_t open[VALIDATOR_MAX_DEPTH];
+  uint32_t depth = 0;
+  uint32_t ops = 0;
+  for (uint32_t i = 0; i < count; ++i) {
+    const validator_field_t *field = &fields[i];
+    if (field->type == VALIDATOR_END) {
+      if (depth == 0 || validator->ops[open[depth - 1]].type != VALIDATOR_OBJECT) {
+        return false;
+      }
+      close_object(validator, open[--depth], ops);
+      close_arrays(validator, open, &depth, ops);
+      continue;
+    }
+    if (ops == VALIDATOR_MAX_OPS || field->type > VALIDATOR_END) {
+      return false;
+    }
+
+    validator_op_t *op = &validator->ops[ops];
+    op->type = field->type;
+    op->width = width_of(field->type);
+    op->fixed = op->width > 0;
+    op->size = op->width;
+    op->field = i;
+    op->next = ops + 1;
+    op->enum_set = field->enum_set;
+    op->bound = field->bound;
+    op->lmcp_type = field->lmcp_type;
+    op->required = field->required;
+    op->range = field->range && op->width > 0;
+    if (op->range) {
+      op->min = field->min;
+      op->max = field->max;
+      op->lane_min = (float) field->min;
+      if (op->lane_min < field->min) {
+        op->lane_min = float_step(op->lane_min, true);
+      }
+      op->lane_max = (float) field->max;
+      if (op->lane_max > field->max) {
+        op->lane_max = float_step(op->lane_max, false);
+      }
+    }
+    ops++;
+
+    if (field->type == VALIDATOR_ARRAY || field->type == VALIDATOR_OBJECT) {
+      if (depth == VALIDATOR_MAX_DEPTH) {
+        return false;
+      }
+      open[depth++] = ops - 1;
+    } else {
+      close_arrays(validator, open, &depth, ops);
+    }
+  }
+
+  // Left empty, rejecting every message, unless the schema is whole
+  validator->count = (depth == 0) ? ops : 0;
+  return depth == 0;
+}
+
+
+//------------------------------------------------------------------------------
+// Checking
+
+static bool fail(walk_t *walk, const validator_op_t *op, size_t position, uint32_t index) {
+  walk->result->path = walk->validator->fields[op->field].path;
+  walk->result->offset = position;
+  walk->result->index = index;
+  return false;
+}
+
+
+static inline bool has(const walk_t *walk, size_t octets) {
+  return walk->size - walk->position >= octets;
+}
+
+
+static bool check_op(walk_t *walk, uint32_t i, uint32_t index);
+
+
+static bool check_ops(walk_t *walk, uint32_t first, uint32_t last, uint32_t index) {
+  for (uint32_t i = first; i < last; i = walk->validator->ops[i].next) {
+    if (!check_op(walk, i, index)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+// The object header at the walk's position; false if it is invalid, and
+// otherwise present set unless the object is null
+static bool check_header(walk_t *walk, const validator_op_t *op, uint32_t index, bool *present) {
+  if (!has(walk, 1)) {
+    return fail(walk, op, walk->position, index);
+  }
+  *present = walk->object[walk->position] != 0;
+  if (!*present) {
+    if (op->required) {
+      return fail(walk, op, walk->position, index);
+    }
+    walk->position += 1;
+    return true;
+  }
+  if (!has(walk, HEADER_SIZE)
+      || get_uint32(&walk->object[walk->position + HEADER_TYPE_OFFSET]) != op->lmcp_type) {
+    return fail(walk, op, walk->position, index);
+  }
+  walk->position += HEADER_SIZE;
+  return true;
+}
+
+
+// The count elements of a list, each the fixed op e, gathered a run at a time
+// and checked field by field
+static bool check_fixed(walk_t *walk, uint32_t e, uint32_t count) {
+  const validator_op_t *element = &walk->validator->ops[e];
+  bool object = element->type == VALIDATOR_OBJECT;
+  uint32_t first = object ? e + 1 : e;
+  uint32_t last = element->next;
+
+  const uint8_t *elements[RUN];
+  uint32_t indices[RUN];
+  for (uint32_t k = 0; k < count; k += RUN) {
+    uint32_t run = (count - k < RUN) ? count - k : RUN;
+    uint32_t n = 0;
+    for (uint32_t j = 0; j < run; ++j) {
+      bool present = true;
+      if (object && !check_header(walk, element, k + j, &present)) {
+        return false;
+      }
+      if (present) {
+        if (!has(walk, element->size)) {
+          return fail(walk, element, walk->position, k + j);
+        }
+        elements[n] = &walk->object[walk->position];
+        indices[n++] = k + j;
+        walk->position += element->size;
+      }
+    }
+
+    for (uint32_t i = first; i < last; ++i) {
+      const validator_op_t *op = &walk->validator->ops[i];
+      uint32_t failed;
+      if (checked(op) && !check_run(op, elements, n, &failed)) {
+        return fail(walk, op, elements[failed] + op->offset - walk->object, indices[failed]);
+      }
+    }
+  }
+  return true;
+}
+
+
+static bool check_op(walk_t *walk, uint32_t i, uint32_t index) {
+  const validator_op_t *op = &walk->validator->ops[i];
+  switch (op->type) {
+  case VALIDATOR_STRING:
+  case VALIDATOR_ARRAY: {
+    if (!has(walk, 2)) {
+      return fail(walk, op, walk->position, index);
+    }
+    uint32_t length = get_uint16(&walk->object[walk->position]);
+    if (op->bound != 0 && length > op->bound) {
+      return fail(walk, op, walk->position, index);
+    }
+    walk->position += 2;
+    if (op->type == VALIDATOR_STRING) {
+      if (!has(walk, length)) {
+        return fail(walk, op, walk->position, index);
+      }
+      walk->position += length;
+      return true;
+    }
+    const validator_op_t *element = &walk->validator->ops[i + 1];
+    if (element->fixed) {
+      return check_fixed(walk, i + 1, length);
+    }
+    for (uint32_t k = 0; k < length; ++k) {
+      if (!check_op(walk, i + 1, k)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  case VALIDATOR_OBJECT: {
+    bool present;
+    if (!check_header(walk, op, index, &present)) {
+      return false;
+    }
+    return !present || check_ops(walk, i + 1, op->next, index);
+  }
+  default:
+    if (!has(walk, op->width)) {
+      return fail(walk, op, walk->position, index);
+    }
+    if (!number_valid(op, &walk->object[walk->position])) {
+      return fail(walk, op, walk->position, index);
+    }
+    walk->position += op->width;
+    return true;
+  }
+}
+
+
+bool validator_check(const validator_t *validator, const uint8_t *object, size_t size,
+                     validator_result_t *result) {
+  walk_t walk = { validator, object, size, 0, result };
+  memset(result, 0, sizeof(*result));
+  if (validator->count == 0 || !check_ops(&walk, 0, validator->count, 0)) {
+    return false;
+  }
+  // The object must end with its last field; octets after it are reported
+  // against the object itself
+  if (walk.position != size) {
+    return fail(&walk, &validator->ops[0], walk.position, 0);
+  }
+  return true;
+}
+
+
+bool validator_check_message(const validator_t *validator, const uint8_t *message, size_t size,
+                             validator_result_t *result) {
+  uint8_t *start = (uint8_t *) message;
+  uint8_t *object;
+  size_t object_size;
+  if (lmcp_find_msg(&start, size, &object, &object_size) != 0) {
+    memset(result, 0, sizeof(*result));
+    return false;
+  }
+  // The LMCP size is as sent; the object must still lie within the message
+  size_t available = message + size - object;
+  return validator_check(validator, object, (object_size < available) ? object_size : available, result);
+}
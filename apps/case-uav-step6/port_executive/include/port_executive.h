@@ -0,0 +1,80 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+// Services a component's input ports in order of priority.
+//
+// Each port is given a priority class and a service function, which dequeues
+// and handles one message and returns false if the port had none.  A pass of
+// the executive services the ports in order of class, and in the order they
+// were added within a class, each to completion: until it has no message
+// left, or until it has serviced its budget of messages in the pass.
+//
+// Between the messages of a port, the ports of the classes above it are
+// serviced first.  A safety alert therefore waits for at most the one message
+// being handled when it arrives, however many telemetry messages are queued
+// behind it.  A budget keeps a port that is fed faster than it is serviced
+// from holding the executive; the rest of its messages wait for the next pass.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+
+#define PORT_EXECUTIVE_MAX_PORTS 8
+
+// Service a port until it has no message left
+#define PORT_EXECUTIVE_DRAIN 0
+
+
+// In order of priority, highest first
+typedef enum port_priority {
+  PORT_PRIORITY_SAFETY,       // alerts, such as return home
+  PORT_PRIORITY_COMMAND,      // requests, responses and mission commands
+  PORT_PRIORITY_TELEMETRY,    // periodic state, such as air vehicle state
+  PORT_PRIORITY_CLASSES
+} port_priority_t;
+
+
+/**
+ * Dequeue and handle one message of a port.  Returns false if there was none.
+ */
+typedef bool (*port_service_t)(void *context);
+
+
+typedef struct port_executive_port {
+  const char *name;
+  port_priority_t priority;
+  port_service_t service;
+  void *context;
+  uint32_t budget;          // messages in a pass, or PORT_EXECUTIVE_DRAIN
+
+  // Statistics
+  uint32_t serviced;        // messages
+  uint32_t exhausted;       // passes that ended with the budget spent
+} port_executive_port_t;
+
+
+typedef struct port_executive {
+  size_t count;
+  port_executive_port_t ports[PORT_EXECUTIVE_MAX_PORTS];  // count of them, in order of priority
+} port_executive_t;
+
+
+void port_executive_init(port_executive_t *executive);
+
+
+/**
+ * Add a port serviced by calling service with context.  Returns false if the
+ * executive already has PORT_EXECUTIVE_MAX_PORTS ports.
+ */
+bool port_executive_add(port_executive_t *executive, const char *name, port_priority_t priority,
+                        port_service_t service, void *context, uint32_t budget);
+
+
+/**
+ * Make one pass over the ports.  Returns the messages serviced.
+ */
+uint32_t port_executive_service(port_executive_t *executive);
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "port_executive.h"
+
+
+void port_executive_init(port_executive_t *executive) {
+  memset(executive, 0, sizeof(*executive));
+}
+
+
+bool port_executive_add(port_executive_t *executive, const char *name, port_priority_t priority,
+                        port_service_t service, void *context, uint32_t budget) {
+  if (executive->count >= PORT_EXECUTIVE_MAX_PORTS) {
+    return false;
+  }
+
+  // Keep the ports in order of priority, after those already added to the class
+  size_t i = executive->count;
+  while (i > 0 && executive->ports[i - 1].priority > priority) {
+    executive->ports[i] = executive->ports[i - 1];
+    i--;
+  }
+  port_executive_port_t *port = &executive->ports[i];
+  memset(port, 0, sizeof(*port));
+  port->name = name;
+  port->priority = priority;
+  port->service = service;
+  port->context = context;
+  port->budget = budget;
+  executive->count++;
+  return true;
+}
+
+
+// Service each port of a class above below, servicing the classes above a port
+// between its messages.  The recursion is no deeper than the classes.
+static uint32_t service_above(port_executive_t *executive, port_priority_t below) {
+  uint32_t total = 0;
+
+  for (size_t i = 0; i < executive->count && executive->ports[i].priority < below; ++i) {
+    port_executive_port_t *port = &executive->ports[i];
+    uint32_t serviced = 0;
+    while (port->budget == PORT_EXECUTIVE_DRAIN || serviced < port->budget) {
+      if (!port->service(port->context)) {
+        break;
+      }
+      serviced++;
+      total += service_above(executive, port->priority);
+    }
+    if (port->budget != PORT_EXECUTIVE_DRAIN && serviced == port->budget) {
+      port->exhausted++;
+    }
+    port->serviced += serviced;
+    total += serviced;
+  }
+  return total;
+}
+
+
+uint32_t port_executive_service(port_executive_t *executive) {
+  return service_above(executive, PORT_PRIORITY_CLASSES);
+}
@@ -74,6 +74,12 @@ void queue_init(queue_t *queue);
 // Enqueue data. This always succeeds and never blocks. Data is copied.
 void queue_enqueue(queue_t *queue, data_t *data);
 
+// Enqueue the first size octets of a payload, copied straight from bytes into
+// the queue. The rest of the payload is zeroed, and octets beyond
+// DATA_T_MAX_PAYLOAD are dropped. Lets a caller holding the payload in its own
+// buffer, such as a CakeML byte array, skip staging it in a data_t.
+void queue_enqueue_bytes(queue_t *queue, const uint8_t *bytes, size_t size);
+
 //------------------------------------------------------------------------------
 // Receiver API
 //
@@ -119,6 +125,22 @@ void recv_queue_init(recv_queue_t *recvQueue, queue_t *queue);
 // ahead of a receiver the system is probably in a very bad state.
 bool queue_dequeue(recv_queue_t *recvQueue, counter_t *numDropped, data_t *data);
 
+// Dequeue as queue_dequeue, but copy at most the first size octets of the
+// payload straight to buffer rather than a whole data_t. The rest of buffer is
+// left as it was. When the dequeue fails, buffer is left in unspecified state.
+bool queue_dequeue_bytes(recv_queue_t *recvQueue, counter_t *numDropped, uint8_t *buffer, size_t size);
+
+// Measure of the octets of a payload in use, such as
+// compute_addr_attr_lmcp_message_size. Returns 0 if it cannot tell.
+typedef size_t (*queue_measure_t)(void *payload, size_t size);
+
+// Dequeue as queue_dequeue_bytes, but copy only the octets of the payload that
+// measure finds in use, setting *length to the number copied. If measure
+// cannot tell, up to size octets are copied, as by queue_dequeue_bytes. Lets a
+// receiver of short messages in large payloads copy only the message.
+bool queue_dequeue_measured(recv_queue_t *recvQueue, counter_t *numDropped, uint8_t *buffer, size_t size,
+                            queue_measure_t measure, size_t *length);
+
 // Is queue empty? If the queue is not empty, it will stay that way until the
 // receiver dequeues all data. If the queue is empty you can make no
 // assumptions about how long it will stay empty.
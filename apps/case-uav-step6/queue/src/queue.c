@@ -20,6 +20,7 @@
 #include <queue.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
 
 //------------------------------------------------------------------------------
 // Sender API
@@ -33,13 +34,24 @@ void queue_init(queue_t *queue) {
 }
 
 void queue_enqueue(queue_t *queue, data_t *data) {
+  queue_enqueue_bytes(queue, data->payload, sizeof(data->payload));
+}
+
+void queue_enqueue_bytes(queue_t *queue, const uint8_t *bytes, size_t size) {
   // Simple ring with one dirty element that will be written next. Only one
   // writer, so no need for any synchronization. elt[queue->numSent %
   // QUEUE_SIZE] is always considered dirty. So do not advance queue-NumSent
   // till AFTER data is copied.
   
   size_t i = queue->numSent % QUEUE_SIZE;
-  queue->elt[i] = *data; // Copy data into queue
+  uint8_t *payload = queue->elt[i].payload;
+  if (size > sizeof(queue->elt[i].payload)) {
+    size = sizeof(queue->elt[i].payload);
+  }
+  if (size > 0) {
+    memcpy(payload, bytes, size); // Copy data into queue
+  }
+  memset(payload + size, 0, sizeof(queue->elt[i].payload) - size);
   // Release memory fence - ensure that data write above completes BEFORE we advance queue->numSent
   __atomic_thread_fence(__ATOMIC_RELEASE);
   ++(queue->numSent);
@@ -56,6 +68,15 @@ void recv_queue_init(recv_queue_t *recvQueue, queue_t *queue) {
 }
 
 bool queue_dequeue(recv_queue_t *recvQueue, counter_t *numDropped, data_t *data) {
+  return queue_dequeue_bytes(recvQueue, numDropped, data->payload, sizeof(data->payload));
+}
+
+bool queue_dequeue_bytes(recv_queue_t *recvQueue, counter_t *numDropped, uint8_t *buffer, size_t size) {
+  return queue_dequeue_measured(recvQueue, numDropped, buffer, size, NULL, NULL);
+}
+
+bool queue_dequeue_measured(recv_queue_t *recvQueue, counter_t *numDropped, uint8_t *buffer, size_t size,
+                            queue_measure_t measure, size_t *length) {
   counter_t *numRecv = &recvQueue->numRecv;
   queue_t *queue = recvQueue->queue;
   // Get a copy of numSent so we can see if it changes durring read
@@ -79,7 +100,21 @@ bool queue_dequeue(recv_queue_t *recvQueue, counter_t *numDropped, data_t *data)
   *numRecv += *numDropped + 1;
   counter_t numRemaining = numSent - *numRecv;
   size_t i = (*numRecv - 1) % QUEUE_SIZE;
-  *data = queue->elt[i]; // Copy data
+  if (size > sizeof(queue->elt[i].payload)) {
+    size = sizeof(queue->elt[i].payload);
+  }
+  if (measure != NULL) {
+    // The element may be being overwritten as it is measured; if it is, the
+    // check below drops it, and the copy is bounded by size whatever it reads
+    size_t used = measure(queue->elt[i].payload, sizeof(queue->elt[i].payload));
+    if (0 < used && used < size) {
+      size = used;
+    }
+  }
+  memcpy(buffer, queue->elt[i].payload, size); // Copy data
+  if (length != NULL) {
+    *length = size;
+  }
   // Acquire memory fence - ensure read of data BEFORE reading queue->numSent again 
   __atomic_thread_fence(__ATOMIC_ACQUIRE);
   if (queue->numSent - *numRecv + 1 < QUEUE_SIZE) {
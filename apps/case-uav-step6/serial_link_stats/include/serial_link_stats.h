@@ -0,0 +1,104 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+// Serial link statistics published by the autopilot serial server (APSS).
+//
+// The APSS owns a serial_link_stats_t dataport and periodically publishes its
+// receive and transmit counters into it.  Readers (for example a relay in the
+// radio VM) take a consistent copy with serial_link_stats_read.  The record is
+// protected by a sequence lock: the single writer makes the sequence odd while
+// it updates the record and even again when it is done, so a reader that sees
+// the same even sequence before and after its copy has a consistent snapshot.
+// Nothing in the record is ever written by a reader.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+
+// Defs to allow easy changing of counter type. Keep these consistent!
+typedef uintmax_t serial_link_counter_t;
+#define SERIAL_LINK_COUNTER_MAX UINTMAX_MAX
+#define PRIserial_link_counter PRIuMAX
+
+
+// Cumulative counters for one direction of the link.  The same structure is
+// kept by each sentinel serial buffer; for the receive buffer "in" is the
+// UART side and "out" the APSS side, and the reverse for transmit.
+typedef struct serial_link_counters {
+  serial_link_counter_t octets_in;          // octets appended to the ring
+  serial_link_counter_t frames_in;          // sentinelized frames appended
+  serial_link_counter_t overflow_drops;     // octets dropped because the ring was full
+  serial_link_counter_t high_water;         // greatest ring occupancy seen, in octets
+  serial_link_counter_t octets_out;         // octets consumed from the ring, including discards
+  serial_link_counter_t frames_out;         // complete, valid frames extracted
+  serial_link_counter_t resync_discards;    // octets skipped searching for a frame start
+  serial_link_counter_t framing_errors;     // frames with an undecodable size field
+  serial_link_counter_t checksum_failures;  // frames with a bad or undecodable checksum
+  serial_link_counter_t oversize_frames;    // frames larger than the reader's buffer
+} serial_link_counters_t;
+
+
+// Rates over the last publication window, per second.
+typedef struct serial_link_rates {
+  uint32_t octets;        // octets on the wire
+  uint32_t frames;        // frames completed
+  uint32_t discards;      // octets lost to overflow or resynchronisation
+  uint32_t errors;        // framing, checksum and oversize failures
+  uint32_t utilization;   // line utilization in tenths of a percent, 8N1 framing
+} serial_link_rates_t;
+
+
+// This is the type of the seL4 dataport (shared memory) that is shared by the
+// APSS and the statistics readers.
+typedef struct serial_link_stats {
+  // Sequence lock, odd while the writer is updating the record
+  serial_link_counter_t sequence;
+
+  uint64_t time_ns;               // time of this publication
+  uint32_t window_ms;             // time since the previous publication
+  uint32_t line_rate;             // configured line rate in bits per second
+
+  serial_link_counters_t rx;
+  serial_link_counters_t tx;
+  serial_link_rates_t rx_rate;
+  serial_link_rates_t tx_rate;
+
+  // Mission commands the APSS superseded or dropped before transmission
+  serial_link_counter_t mission_commands_superseded;
+  serial_link_counter_t mission_commands_dropped;
+
+  // Air vehicle state messages not forwarded because of the output policies
+  serial_link_counter_t air_vehicle_states_suppressed;
+} serial_link_stats_t;
+
+
+//------------------------------------------------------------------------------
+// Writer API
+//
+// Publish update into stats.  The caller fills in time_ns, line_rate, the
+// counters and the mission command and air vehicle state fields of update;
+// window_ms and the rates are computed here from the previous publication.
+// Only one thread may publish into a given stats record.
+void serial_link_stats_publish(serial_link_stats_t *stats, const serial_link_stats_t *update);
+
+
+//------------------------------------------------------------------------------
+// Reader API
+//
+// Copy a consistent snapshot of stats into copy.  Returns false if the writer
+// was still updating the record after a bounded number of attempts, or if
+// nothing has been published yet.
+bool serial_link_stats_read(const serial_link_stats_t *stats, serial_link_stats_t *copy);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ */
+
+#include <serial_link_stats.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// Attempts a reader makes before giving up on a busy writer
+#define SERIAL_LINK_STATS_READ_ATTEMPTS 16
+
+#define NS_PER_MS 1000000ULL
+#define MS_PER_S  1000ULL
+
+// Bits on the wire per octet with one start and one stop bit
+#define BITS_PER_OCTET 10ULL
+
+
+//------------------------------------------------------------------------------
+// Writer API
+//
+// See serial_link_stats.h for API documentation. Only implementation details are documented here.
+
+static uint32_t rate_per_s(serial_link_counter_t previous, serial_link_counter_t current, uint64_t window_ms) {
+  uint64_t rate = ((uint64_t) (current - previous) * MS_PER_S) / window_ms;
+  return (rate > UINT32_MAX) ? UINT32_MAX : (uint32_t) rate;
+}
+
+static void compute_rates(serial_link_rates_t *rates, uint32_t line_rate, uint64_t window_ms,
+                          serial_link_counter_t octets_previous, serial_link_counter_t octets,
+                          serial_link_counter_t frames_previous, serial_link_counter_t frames,
+                          const serial_link_counters_t *previous, const serial_link_counters_t *current) {
+  rates->octets = rate_per_s(octets_previous, octets, window_ms);
+  rates->frames = rate_per_s(frames_previous, frames, window_ms);
+  rates->discards = rate_per_s(previous->overflow_drops + previous->resync_discards,
+                               current->overflow_drops + current->resync_discards, window_ms);
+  rates->errors = rate_per_s(previous->framing_errors + previous->checksum_failures + previous->oversize_frames,
+                             current->framing_errors + current->checksum_failures + current->oversize_frames,
+                             window_ms);
+  rates->utilization = (line_rate > 0) ? (uint32_t) (((uint64_t) rates->octets * BITS_PER_OCTET * 1000) / line_rate) : 0;
+}
+
+void serial_link_stats_publish(serial_link_stats_t *stats, const serial_link_stats_t *update) {
+  serial_link_stats_t next = *update;
+  serial_link_counter_t sequence = stats->sequence;
+
+  // The first publication has no previous window to compute rates against
+  uint64_t window_ms = (sequence != 0 && update->time_ns > stats->time_ns)
+    ? (update->time_ns - stats->time_ns) / NS_PER_MS : 0;
+  next.window_ms = (window_ms > UINT32_MAX) ? UINT32_MAX : (uint32_t) window_ms;
+  if (window_ms > 0) {
+    // Receive: octets and frames the UART delivered; transmit: octets put on the
+    // UART and frames queued for it
+    compute_rates(&next.rx_rate, update->line_rate, window_ms,
+                  stats->rx.octets_in, update->rx.octets_in, stats->rx.frames_out, update->rx.frames_out,
+                  &stats->rx, &update->rx);
+    compute_rates(&next.tx_rate, update->line_rate, window_ms,
+                  stats->tx.octets_out, update->tx.octets_out, stats->tx.frames_in, update->tx.frames_in,
+                  &stats->tx, &update->tx);
+  } else {
+    memset(&next.rx_rate, 0, sizeof(next.rx_rate));
+    memset(&next.tx_rate, 0, sizeof(next.tx_rate));
+  }
+
+  // Mark the record busy, making sure readers see the odd sequence before any
+  // of the data changes
+  __atomic_store_n(&stats->sequence, sequence + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  next.sequence = sequence + 1;
+  *stats = next;
+
+  // Release memory fence - ensure the data writes above complete BEFORE the
+  // sequence becomes even again
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  __atomic_store_n(&stats->sequence, sequence + 2, __ATOMIC_RELAXED);
+}
+
+
+//------------------------------------------------------------------------------
+// Reader API
+//
+// See serial_link_stats.h for API documentation. Only implementation details are documented here.
+
+bool serial_link_stats_read(const serial_link_stats_t *stats, serial_link_stats_t *copy) {
+  for (int attempt = 0; attempt < SERIAL_LINK_STATS_READ_ATTEMPTS; ++attempt) {
+    serial_link_counter_t before = __atomic_load_n(&stats->sequence, __ATOMIC_RELAXED);
+    // Acquire memory fence - ensure the sequence is read BEFORE the data
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (before == 0) {
+      return false;
+    }
+    if (before % 2 != 0) {
+      continue;
+    }
+    memcpy(copy, (const void *) stats, sizeof(*copy));
+    // Acquire memory fence - ensure the data is read BEFORE the sequence is re-read
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&stats->sequence, __ATOMIC_RELAXED) == before) {
+      copy->sequence = before;
+      return true;
+    }
+  }
+  return false;
+}
@@ -26,5 +26,9 @@ set(KernelArmVtimerUpdateVOffset OFF CACHE BOOL "" FORCE)
 # Don't trap WFI or WFE instructions in a VM.
 set(KernelArmDisableWFIWFETraps ON CACHE BOOL "" FORCE)
 
-set(KernelNumDomains 15 CACHE STRING "" FORCE)
+# Let components read the generic timer's virtual count (WaypointManager
+# window transition latency).
+set(KernelArmExportVCNTUser ON CACHE BOOL "" FORCE)
+
+set(KernelNumDomains 17 CACHE STRING "" FORCE)
 set(KernelDomainSchedule "${CMAKE_CURRENT_LIST_DIR}/vm/domain_schedule.c" CACHE INTERNAL "")
@@ -44,23 +44,27 @@ const dschedule_t ksDomSchedule[] = {
   { .domain =  0, .length = 1 },   // 092 ms : 2 ms seL4, APSS
   { .domain =  7, .length = 4 },   // 094 ms : 8 ms LST filter
   { .domain =  0, .length = 1 },   // 102 ms : 2 ms seL4, APSS
-  { .domain =  8, .length = 1 },   // 104 ms : 2 ms conn08, conn12, conn15
+  { .domain = 15, .length = 1 },   // 104 ms : 2 ms OR filter
   { .domain =  0, .length = 1 },   // 106 ms : 2 ms seL4, APSS
-  { .domain =  9, .length = 4 },   // 108 ms : 8 ms vmUxAS
-  { .domain =  0, .length = 1 },   // 116 ms : 2 ms seL4, APSS
-  { .domain =  9, .length = 4 },   // 118 ms : 8 ms vmUxAS
-  { .domain =  0, .length = 1 },   // 126 ms : 2 ms seL4, APSS
-  { .domain =  9, .length = 4 },   // 128 ms : 8 ms vmUxAS
-  { .domain =  0, .length = 1 },   // 136 ms : 2 ms seL4, APSS
-  { .domain =  9, .length = 4 },   // 138 ms : 8 ms vmUxAS
-  { .domain =  0, .length = 1 },   // 146 ms : 2 ms seL4, APSS
-  { .domain =  9, .length = 4 },   // 148 ms : 8 ms vmUxAS
-  { .domain =  0, .length = 1 },   // 156 ms : 2 ms seL4, APSS
-  { .domain =  9, .length = 4 },   // 158 ms : 8 ms vmUxAS
-  { .domain =  0, .length = 1 },   // 166 ms : 2 ms seL4, APSS
-  { .domain =  9, .length = 4 },   // 168 ms : 8 ms vmUxAS
-  { .domain =  0, .length = 1 },   // 176 ms : 2 ms seL4, APSS
-  { .domain =  9, .length = 4 },   // 178 ms : 8 ms vmUxAS
+  { .domain = 16, .length = 1 },   // 108 ms : 2 ms AR filter
+  { .domain =  0, .length = 1 },   // 110 ms : 2 ms seL4, APSS
+  { .domain =  8, .length = 1 },   // 112 ms : 2 ms conn08, conn09, conn12, conn15, conn22
+  { .domain =  0, .length = 1 },   // 114 ms : 2 ms seL4, APSS
+  { .domain =  9, .length = 4 },   // 116 ms : 8 ms vmUxAS
+  { .domain =  0, .length = 1 },   // 124 ms : 2 ms seL4, APSS
+  { .domain =  9, .length = 3 },   // 126 ms : 6 ms vmUxAS
+  { .domain =  0, .length = 1 },   // 132 ms : 2 ms seL4, APSS
+  { .domain =  9, .length = 4 },   // 134 ms : 8 ms vmUxAS
+  { .domain =  0, .length = 1 },   // 142 ms : 2 ms seL4, APSS
+  { .domain =  9, .length = 3 },   // 144 ms : 6 ms vmUxAS
+  { .domain =  0, .length = 1 },   // 150 ms : 2 ms seL4, APSS
+  { .domain =  9, .length = 4 },   // 152 ms : 8 ms vmUxAS
+  { .domain =  0, .length = 1 },   // 160 ms : 2 ms seL4, APSS
+  { .domain =  9, .length = 3 },   // 162 ms : 6 ms vmUxAS
+  { .domain =  0, .length = 1 },   // 168 ms : 2 ms seL4, APSS
+  { .domain =  9, .length = 4 },   // 170 ms : 8 ms vmUxAS
+  { .domain =  0, .length = 1 },   // 178 ms : 2 ms seL4, APSS
+  { .domain =  9, .length = 3 },   // 180 ms : 6 ms vmUxAS
   { .domain =  0, .length = 1 },   // 186 ms : 2 ms seL4, APSS
   { .domain =  9, .length = 4 },   // 188 ms : 8 ms vmUxAS
   { .domain =  0, .length = 1 },   // 196 ms : 2 ms seL4, APSS
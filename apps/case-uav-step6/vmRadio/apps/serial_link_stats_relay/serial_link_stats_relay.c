@@ -0,0 +1,149 @@
+/*
+ * Copyright 2020, Collins Aerospace
+ *
+ * This software may be distributed and modified according to the terms of
+ * the GNU General Public License version 2. Note that NO WARRANTY is provided.
+ * See "LICENSE_GPLv3.txt" for details.
+ */
+
+/*
+ * Relays the autopilot serial link statistics published by the APSS to a UDP
+ * destination, one text datagram per new publication.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <serial_link_stats.h>
+
+
+// The APSS publishes about once a second, poll a little faster than that
+#define POLL_INTERVAL_US 250000
+
+#define REPORT_SIZE 2048
+
+
+static int format_counters(char *buffer, size_t size, const char *name, const serial_link_counters_t *counters,
+                           const serial_link_rates_t *rates) {
+    return snprintf(buffer, size,
+                    " %s_octets_in=%" PRIserial_link_counter " %s_frames_in=%" PRIserial_link_counter
+                    " %s_overflow_drops=%" PRIserial_link_counter " %s_high_water=%" PRIserial_link_counter
+                    " %s_octets_out=%" PRIserial_link_counter " %s_frames_out=%" PRIserial_link_counter
+                    " %s_resync_discards=%" PRIserial_link_counter " %s_framing_errors=%" PRIserial_link_counter
+                    " %s_checksum_failures=%" PRIserial_link_counter " %s_oversize_frames=%" PRIserial_link_counter
+                    " %s_octets_per_s=%" PRIu32 " %s_frames_per_s=%" PRIu32 " %s_discards_per_s=%" PRIu32
+                    " %s_errors_per_s=%" PRIu32 " %s_utilization_permille=%" PRIu32,
+                    name, counters->octets_in, name, counters->frames_in,
+                    name, counters->overflow_drops, name, counters->high_water,
+                    name, counters->octets_out, name, counters->frames_out,
+                    name, counters->resync_discards, name, counters->framing_errors,
+                    name, counters->checksum_failures, name, counters->oversize_frames,
+                    name, rates->octets, name, rates->frames, name, rates->discards,
+                    name, rates->errors, name, rates->utilization);
+}
+
+
+static size_t format_report(char *buffer, size_t size, const serial_link_stats_t *stats) {
+    int length = snprintf(buffer, size, "apss_serial_link time_ns=%" PRIu64 " window_ms=%" PRIu32 " line_rate=%" PRIu32,
+                          stats->time_ns, stats->window_ms, stats->line_rate);
+    length += format_counters(buffer + length, size - length, "rx", &stats->rx, &stats->rx_rate);
+    length += format_counters(buffer + length, size - length, "tx", &stats->tx, &stats->tx_rate);
+    length += snprintf(buffer + length, size - length,
+                       " mission_commands_superseded=%" PRIserial_link_counter
+                       " mission_commands_dropped=%" PRIserial_link_counter
+                       " air_vehicle_states_suppressed=%" PRIserial_link_counter "\n",
+                       stats->mission_commands_superseded, stats->mission_commands_dropped,
+                       stats->air_vehicle_states_suppressed);
+    return ((size_t) length < size) ? (size_t) length : size - 1;
+}
+
+
+int main(int argc, char *argv[])
+{
+
+    if (argc != 3) {
+        printf("Usage: %s <camkes_device> <udp_destination>\n\n"
+               "Relays the serial link statistics in the specified dataport file to the specified UDP destination (x.x.x.x:y)",
+               argv[0]);
+        return 1;
+    }
+
+    char *dataport_name = argv[1];
+    int dataport_fd = open(dataport_name, O_RDWR);
+    assert(dataport_fd >= 0);
+
+    serial_link_stats_t *dataport;
+    if ((dataport = (serial_link_stats_t *) mmap(NULL, sizeof(serial_link_stats_t), PROT_READ, MAP_SHARED,
+                                                 dataport_fd, 1 * getpagesize())) == (void *) -1) {
+        printf("mmap failed\n");
+        close(dataport_fd);
+        exit(1);
+    }
+
+    struct sockaddr_in client_sockaddr, destination_sockaddr;
+
+    memset((void *) &client_sockaddr, 0, sizeof(struct sockaddr_in));
+    client_sockaddr.sin_family = AF_INET;
+    client_sockaddr.sin_addr.s_addr = htonl(INADDR_ANY);
+    client_sockaddr.sin_port = htons(0);
+
+    char *destination_address = strtok(argv[2], ":");
+    char *destination_port = strtok(NULL, ":");
+    memset((void *) &destination_sockaddr, 0, sizeof(struct sockaddr_in));
+    destination_sockaddr.sin_family = AF_INET;
+    destination_sockaddr.sin_addr.s_addr = inet_addr(destination_address);
+    destination_sockaddr.sin_port = htons((destination_port != NULL) ? atoi(destination_port) : 5579);
+    printf("serial_link_stats_relay: setting UDP destination to %s:%u\n",
+        inet_ntoa(destination_sockaddr.sin_addr), (unsigned) ntohs(destination_sockaddr.sin_port));
+
+    int destination_fd = -1;
+    if ((destination_fd = socket(AF_INET, SOCK_DGRAM, 0)) < 0)
+    {
+        printf("serial_link_stats_relay: could not create destination socket: %s\n", strerror(errno));
+        munmap(dataport, sizeof(serial_link_stats_t));
+        close(dataport_fd);
+        exit(1);
+    }
+
+    if (bind(destination_fd, (struct sockaddr *) &client_sockaddr, sizeof(struct sockaddr_in)) < 0)
+    {
+        printf("serial_link_stats_relay: could not bind to client address: %s\n", strerror(errno));
+        close(destination_fd);
+        munmap(dataport, sizeof(serial_link_stats_t));
+        close(dataport_fd);
+        exit(1);
+    }
+
+    serial_link_stats_t stats;
+    serial_link_counter_t last_sequence = 0;
+    char report[REPORT_SIZE];
+
+    while (1) {
+        if (serial_link_stats_read(dataport, &stats) && stats.sequence != last_sequence) {
+            last_sequence = stats.sequence;
+            size_t length = format_report(report, sizeof(report), &stats);
+            if (sendto(destination_fd, report, length, 0, (struct sockaddr *) &destination_sockaddr,
+                       sizeof(struct sockaddr_in)) < 0) {
+                printf("serial_link_stats_relay: sendto failed: %s\n", strerror(errno));
+            }
+        }
+        usleep(POLL_INTERVAL_US);
+    }
+
+    close(destination_fd);
+    munmap(dataport, sizeof(serial_link_stats_t));
+    close(dataport_fd);
+    exit(0);
+}
@@ -33,9 +33,11 @@
 //
 //    dataport queue_t attestation_id_list_out_crossvm_dp;
 //    emits SendEvent attestation_id_list_out_ready;
+//
+//    dataport serial_link_stats_t serial_link_stats_in_crossvm_dp;
 
 
-#define NUM_CONNECTIONS 5
+#define NUM_CONNECTIONS 6
 static struct camkes_crossvm_connection connections[NUM_CONNECTIONS];
 
 // these are defined in the dataport's glue code
@@ -54,6 +56,8 @@ seL4_Word uxas_log_in_done_notification_badge(void);
 extern dataport_caps_handle_t attestation_id_list_out_crossvm_dp_handle;
 void attestation_id_list_out_ready_emit_underlying(void); 
 
+extern dataport_caps_handle_t serial_link_stats_in_crossvm_dp_handle;
+
 
 static int consume_callback(vm_t *vm, void *cookie)
 {
@@ -94,6 +98,12 @@ void init_cross_vm_connections(vm_t *vm, void *cookie)
         .consume_badge = -1
     };
 
+    connections[5] = (struct camkes_crossvm_connection) {
+        .handle = &serial_link_stats_in_crossvm_dp_handle,
+        .emit_fn = NULL,
+        .consume_badge = -1
+    };
+
     for (int i = 0; i < NUM_CONNECTIONS; i++) {
         if (connections[i].consume_badge != -1) {
             int err = register_async_event_handler(connections[i].consume_badge, consume_callback, (void *)connections[i].consume_badge);